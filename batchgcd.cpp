@@ -0,0 +1,292 @@
+#include "batchgcd.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <numeric>
+#include <vector>
+#include "montgomery.hpp"
+
+//nonnegative integers as little endian 64 bit words, with no leading zero words (so 0 is empty)
+using Words = std::vector<uint64_t>;
+
+static void trim(Words& a) {
+    while (!a.empty() && !a.back()) a.pop_back();
+}
+
+static bool isLess(const Words& a, const Words& b) {
+    if (a.size() != b.size()) return a.size() < b.size();
+    return std::lexicographical_compare(a.rbegin(), a.rend(), b.rbegin(), b.rend());
+}
+
+static Words multiply(const Words& a, const Words& b) {
+    if (a.empty() || b.empty()) return {};
+    Words product(a.size() + b.size(), 0);
+    for (size_t i { 0 }; i < a.size(); ++i) {
+        uint64_t carry { 0 };
+        for (size_t j { 0 }; j < b.size(); ++j) {
+            const unsigned __int128 t { static_cast<unsigned __int128>(a[i]) * b[j] + product[i + j] + carry };
+            product[i + j] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+        }
+        product[i + b.size()] = carry;
+    }
+    trim(product);
+    return product;
+}
+
+//divides two word numbers by a fixed normalized word d with a precomputed reciprocal rather than a hardware division
+//(moller and granlund, "improved division by invariant integers", algorithm 4)
+class WordDivisor {
+public:
+    //precondition: the high bit of d_ is set
+    explicit WordDivisor(const uint64_t d_) : d(d_), reciprocal(static_cast<uint64_t>(~static_cast<unsigned __int128>(0) / d_)) {}
+
+    //returns (high * 2^64 + low) / d, setting r to the remainder
+    //precondition: high < d
+    uint64_t divide(const uint64_t high, const uint64_t low, uint64_t& r) const {
+        const unsigned __int128 estimate { static_cast<unsigned __int128>(reciprocal) * high + ((static_cast<unsigned __int128>(high) << 64) | low) };
+        uint64_t q { static_cast<uint64_t>(estimate >> 64) + 1 };
+        r = low - q * d;
+        if (r > static_cast<uint64_t>(estimate)) {
+            --q;
+            r += d;
+        }
+        if (r >= d) {
+            ++q;
+            r -= d;
+        }
+        return q;
+    }
+
+private:
+    uint64_t d;
+    //floor((2^128 - 1) / d) - 2^64
+    uint64_t reciprocal;
+};
+
+//u mod v, by knuth's algorithm D (TAOCP vol. 2, 4.3.1)
+//precondition: v is nonzero
+static Words remainder(const Words& u, const Words& v) {
+    if (isLess(u, v)) return u;
+
+    //normalized so that v's top word has its high bit set, which keeps each quotient word estimate within 2 of the truth
+    const size_t n { v.size() }, m { u.size() - n };
+    const unsigned shift { static_cast<unsigned>(std::countl_zero(v.back())) };
+    const auto shiftedWord = [&](const Words& a, const size_t i) {
+        const uint64_t low { i ? a[i - 1] : 0 }, high { i < a.size() ? a[i] : 0 };
+        return shift ? (high << shift) | (low >> (64 - shift)) : high;
+    };
+    Words vn(n), un(u.size() + 1);
+    for (size_t i { 0 }; i < n; ++i) vn[i] = shiftedWord(v, i);
+    for (size_t i { 0 }; i <= u.size(); ++i) un[i] = shiftedWord(u, i);
+    const WordDivisor top(vn[n - 1]);
+
+    if (n == 1) {
+        uint64_t r { un[u.size()] };
+        for (size_t i { u.size() }; i--; ) top.divide(r, un[i], r);
+        r >>= shift;
+        return r ? Words { r } : Words {};
+    }
+
+    for (size_t j { m + 1 }; j--; ) {
+        //the top word of the window never exceeds vn's, and only equals it when the quotient word is 2^64 - 1 or 2^64 - 2
+        uint64_t qhat, rhat;
+        bool rhatOverflowed { false };
+        if (un[j + n] < vn[n - 1]) qhat = top.divide(un[j + n], un[j + n - 1], rhat);
+        else {
+            qhat = ~uint64_t { 0 };
+            rhat = un[j + n - 1] + vn[n - 1];
+            rhatOverflowed = rhat < vn[n - 1];
+        }
+        while (!rhatOverflowed && static_cast<unsigned __int128>(qhat) * vn[n - 2] > ((static_cast<unsigned __int128>(rhat) << 64) | un[j + n - 2])) {
+            --qhat;
+            rhat += vn[n - 1];
+            rhatOverflowed = rhat < vn[n - 1];
+        }
+
+        //subtracts qhat * vn from the window of un starting at j
+        uint64_t carry { 0 }, borrow { 0 };
+        for (size_t i { 0 }; i < n; ++i) {
+            const unsigned __int128 p { static_cast<unsigned __int128>(qhat) * vn[i] + carry };
+            carry = static_cast<uint64_t>(p >> 64);
+            const uint64_t subtrahend { static_cast<uint64_t>(p) }, difference { un[i + j] - subtrahend };
+            const uint64_t newBorrow { static_cast<uint64_t>(un[i + j] < subtrahend) + (difference < borrow) };
+            un[i + j] = difference - borrow;
+            borrow = newBorrow;
+        }
+        const unsigned __int128 subtrahend { static_cast<unsigned __int128>(carry) + borrow };
+        const bool negative { un[j + n] < subtrahend };
+        un[j + n] -= static_cast<uint64_t>(subtrahend);
+
+        //qhat was one too large, so vn is added back once
+        if (negative) {
+            uint64_t addCarry { 0 };
+            for (size_t i { 0 }; i < n; ++i) {
+                const unsigned __int128 sum { static_cast<unsigned __int128>(un[i + j]) + vn[i] + addCarry };
+                un[i + j] = static_cast<uint64_t>(sum);
+                addCarry = static_cast<uint64_t>(sum >> 64);
+            }
+            un[j + n] += addCarry;
+        }
+    }
+
+    Words r(n);
+    for (size_t i { 0 }; i < n; ++i) r[i] = shift ? (un[i] >> shift) | (un[i + 1] << (64 - shift)) : un[i];
+    trim(r);
+    return r;
+}
+
+//u * 2^(-64 * u.size()) mod v, by montgomery reduction a word at a time
+//this costs the multiply-adds of a schoolbook multiplication, without the quotient estimates and corrections of algorithm D,
+//and the extra power of 2 is a unit modulo any odd v, so it makes no difference to a gcd taken later
+//precondition: v is odd
+static Words montgomeryRemainder(const Words& u, const Words& v) {
+    const size_t n { v.size() }, m { u.size() };
+    //-1 / v mod 2^64 by newton's iteration, from an inverse correct to 3 bits that each step doubles
+    uint64_t inverse { v[0] };
+    for (int i { 0 }; i < 5; ++i) inverse *= 2 - v[0] * inverse;
+    const uint64_t negatedInverse { ~inverse + 1 };
+
+    //each step adds the multiple of v that clears the lowest word left, so t never exceeds u + v * 2^(64 * m)
+    Words t(m + n + 1, 0);
+    std::copy(u.begin(), u.end(), t.begin());
+    for (size_t i { 0 }; i < m; ++i) {
+        const uint64_t q { t[i] * negatedInverse };
+        uint64_t carry { 0 };
+        for (size_t j { 0 }; j < n; ++j) {
+            const unsigned __int128 s { static_cast<unsigned __int128>(q) * v[j] + t[i + j] + carry };
+            t[i + j] = static_cast<uint64_t>(s);
+            carry = static_cast<uint64_t>(s >> 64);
+        }
+        for (size_t k { i + n }; carry; ++k) {
+            t[k] += carry;
+            carry = t[k] < carry;
+        }
+    }
+
+    Words r(t.begin() + m, t.end());
+    trim(r);
+    //r < u / 2^(64 * m) + v <= 1 + v, so r is either reduced already or exactly v
+    if (!isLess(r, v)) r.clear();
+    return r;
+}
+
+//product of every odd prime below batchGcdBound, built once
+static const Words& smallPrimeProduct(void) {
+    static const Words product = [] {
+        const TrialDivisionKernel& kernel { TrialDivisionKernel::get() };
+        Words p { 1 };
+        //primes are gathered into words first, so that the product grows by a word at a time rather than a prime at a time
+        uint64_t word { 1 };
+        const auto multiplyIn = [&](const uint64_t factor) {
+            uint64_t carry { 0 };
+            for (uint64_t& w : p) {
+                const unsigned __int128 t { static_cast<unsigned __int128>(w) * factor + carry };
+                w = static_cast<uint64_t>(t);
+                carry = static_cast<uint64_t>(t >> 64);
+            }
+            if (carry) p.push_back(carry);
+        };
+        for (size_t i { 0 }; i < kernel.getPrimeCount(); ++i) {
+            const uint64_t prime { kernel.getPrime(i) };
+            if (word > std::numeric_limits<uint64_t>::max() / prime) {
+                multiplyIn(word);
+                word = 1;
+            }
+            word *= prime;
+        }
+        multiplyIn(word);
+        return p;
+    }();
+    return product;
+}
+
+void primes::batchSmoothParts(std::span<const uint64_t> inputs, std::span<uint64_t> smoothParts) {
+    const Words& p { smallPrimeProduct() };
+    //reducing P at the root costs about as much per input whatever the group size, while the levels below cost more per input
+    //the larger the group, so groups are kept small, but large enough that the few short products at the top are not dominant
+    constexpr size_t groupSize { 64 };
+
+    //odd parts of the inputs of the current group, and where their results go
+    std::vector<uint64_t> oddParts;
+    std::vector<size_t> indices;
+    //levels[0] holds the odd parts, and each level above the products of adjacent pairs of the one below
+    std::vector<std::vector<Words>> levels;
+    for (size_t groupStart { 0 }; groupStart < inputs.size(); groupStart += groupSize) {
+        oddParts.clear();
+        indices.clear();
+        for (size_t i { groupStart }; i < std::min(groupStart + groupSize, inputs.size()); ++i) {
+            const uint64_t n { inputs[i] };
+            if (!n) smoothParts[i] = 0;
+            else if (const uint64_t odd { n >> std::countr_zero(n) }; odd == 1) smoothParts[i] = 1;
+            else {
+                oddParts.push_back(odd);
+                indices.push_back(i);
+            }
+        }
+        if (oddParts.empty()) continue;
+
+        levels.assign(1, {});
+        for (const uint64_t odd : oddParts) levels[0].push_back({ odd });
+        while (levels.back().size() > 1) {
+            const std::vector<Words>& below { levels.back() };
+            std::vector<Words> above;
+            for (size_t j { 0 }; j + 1 < below.size(); j += 2) above.push_back(multiply(below[j], below[j + 1]));
+            //an unpaired node is carried up as it is
+            if (below.size() % 2) above.push_back(below.back());
+            levels.push_back(std::move(above));
+        }
+
+        //remainder tree: P mod each node, from P mod the root down to P mod each odd part (all times the same power of 2)
+        //each level overwrites the one above it, which is no longer needed
+        std::vector<Words> remainders { montgomeryRemainder(p, levels.back()[0]) };
+        for (size_t level { levels.size() - 1 }; level--; ) {
+            std::vector<Words> below(levels[level].size());
+            for (size_t j { 0 }; j < below.size(); ++j) below[j] = remainder(remainders[j / 2], levels[level][j]);
+            remainders = std::move(below);
+        }
+
+        for (size_t j { 0 }; j < oddParts.size(); ++j) {
+            const uint64_t n { oddParts[j] }, r { remainders[j].empty() ? 0 : remainders[j][0] };
+            //every prime below the bound divides P exactly once, and divides n at most 40 times (3^41 > 2^64),
+            //so P^64 mod n shares with n exactly its part made of those primes
+            const Montgomery<uint64_t> mont(n);
+            uint64_t x { mont.toMont(r) };
+            for (int k { 0 }; k < 6; ++k) x = mont.mul(x, x);
+            smoothParts[indices[j]] = std::gcd(mont.fromMont(x), n);
+        }
+    }
+}
+
+void primes::batchGcdFactorization(std::span<const uint64_t> inputs, std::span<Factorization> factorizations, const Engine engine) {
+    std::vector<uint64_t> smoothParts(inputs.size());
+    batchSmoothParts(inputs, smoothParts);
+
+    const TrialDivisionKernel& kernel { TrialDivisionKernel::get() };
+    for (size_t i { 0 }; i < inputs.size(); ++i) {
+        Factorization& factorization { factorizations[i] };
+        factorization = Factorization();
+        const uint64_t n { inputs[i] };
+        if (n < 2) continue;
+
+        if (const unsigned twos { static_cast<unsigned>(std::countr_zero(n)) }) factorization.addNewFactor(2, twos);
+        //smooth is made only of primes below the bound, so the kernel finds all but the greatest, which is left once the rest pass its square root
+        uint64_t smooth { smoothParts[i] };
+        const uint64_t cofactor { (n >> std::countr_zero(n)) / smooth };
+        for (size_t j { kernel.findDivisor(smooth, 0, isqrt(smooth)) }; j < kernel.getPrimeCount(); j = kernel.findDivisor(smooth, j + 1, isqrt(smooth))) {
+            uint_fast8_t exp { 0 };
+            for (; kernel.divides(smooth, j); ++exp) smooth = kernel.divideExact(smooth, j);
+            factorization.addNewFactor(kernel.getPrime(j), exp);
+        }
+        if (smooth > 1) factorization.addNewFactor(smooth, 1);
+
+        if (cofactor == 1) continue;
+        //every factor of cofactor is at least batchGcdBound, so it is prime if there is no room for two of them
+        if (cofactor / batchGcdBound < batchGcdBound) factorization.addNewFactor(cofactor, 1);
+        else {
+            const Factorization cofactorFactorization { primeFactorization(cofactor, engine) };
+            for (const auto& [base, exp] : cofactorFactorization.viewFactors()) factorization.addNewFactor(base, exp);
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "factorization.hpp"
+#include "primes.hpp"
+#include "trialkernel.hpp"
+
+//bernstein's batch gcd, which finds the small prime factors of many inputs at once rather than trial dividing each input by every small prime
+//the product P of every odd prime below batchGcdBound is reduced modulo a product tree of the inputs, and the remainders are carried
+//down the tree to give P mod n for every n; the part of n made of primes below the bound is then gcd(n, (P mod n)^64 mod n)
+//arithmetic is schoolbook (no FFT multiplication or newton division), so inputs are grouped into small trees, and the cost per input
+//is about proportional to the size of P in words (~1500) rather than to the number of primes below the bound (~6500)
+namespace primes {
+    //the primes covered by TrialDivisionKernel, so that the smooth parts found can be factored with it
+    static constexpr uint64_t batchGcdBound = TrialDivisionKernel::kernelBound;
+
+    //sets smoothParts[i] to the greatest divisor of inputs[i] with no odd prime factor of batchGcdBound or more, and no factor of 2
+    //(0 for an input of 0)
+    //precondition: smoothParts.size() >= inputs.size()
+    void batchSmoothParts(std::span<const uint64_t> inputs, std::span<uint64_t> smoothParts);
+
+    //factors every input, splitting off each input's factors below batchGcdBound with batchSmoothParts
+    //the remaining cofactors have no factor below the bound, so are prime if below its square, and are otherwise factored one at a time with engine
+    //best suited to the rho and tiered engines, as the trial division engine starts its own pass over the small primes again
+    //precondition: factorizations.size() >= inputs.size()
+    void batchGcdFactorization(std::span<const uint64_t> inputs, std::span<Factorization> factorizations, const Engine engine = Engine::TIERED);
+}
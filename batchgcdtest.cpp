@@ -0,0 +1,43 @@
+#include <cstdint>
+#include <print>
+#include <vector>
+#include "batchgcd.hpp"
+#include "primes.hpp"
+#include "splitmix64.hpp"
+#include "workloads.hpp"
+
+//checks primes::batchGcdFactorization against primes::primeFactorization, including inputs whose cofactor left after the smooth part
+//is composite, i.e. has two or more prime factors of at least primes::batchGcdBound and so is factored again with the engine
+//exits nonzero if any input is factored differently
+int main(void) {
+    SplitMix64 gen(0x6a09e667f3bcc908);
+    const auto largePrime = [&](const unsigned bits) { return randomPrime(gen, bits); };
+
+    std::vector<uint64_t> inputs { 0, 1, 2, 65536, 65537ull * 65539, 65537ull * 65537, 65521ull * 65537 * 65539, 18446744073709551557ull };
+    for (unsigned i { 0 }; i < 256; ++i) {
+        //smooth part times two large primes
+        inputs.push_back((gen() % 255 + 1) * largePrime(17 + i % 8) * largePrime(17 + i % 12));
+        //three large primes
+        inputs.push_back(largePrime(17 + i % 4) * largePrime(17 + i % 5) * largePrime(17 + i % 6));
+        //a large prime squared, which the engine must find as a perfect power
+        const uint64_t p { largePrime(17 + i % 16) };
+        inputs.push_back(p * p);
+        //balanced semiprime
+        inputs.push_back(largePrime(32) * largePrime(31));
+    }
+    for (const Workload workload : workloads) for (const uint64_t n : generateWorkload(workload, 64, 256, 1)) inputs.push_back(n);
+
+    unsigned mismatches { 0 };
+    for (const primes::Engine engine : { primes::Engine::POLLARD_RHO, primes::Engine::TIERED }) {
+        std::vector<Factorization> factorizations(inputs.size());
+        primes::batchGcdFactorization(inputs, factorizations, engine);
+        for (size_t i { 0 }; i < inputs.size(); ++i) {
+            const std::string expected { primes::primeFactorization(inputs[i], primes::Engine::TIERED).asString() }, found { factorizations[i].asString() };
+            if (found == expected) continue;
+            std::println(stderr, "engine {}: {} factored as {}, expected {}", static_cast<int>(engine), inputs[i], found, expected);
+            ++mismatches;
+        }
+    }
+    std::println("{} inputs checked per engine, {} mismatches", inputs.size(), mismatches);
+    return mismatches != 0;
+}
@@ -0,0 +1,104 @@
+#include "batchinput.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool isSeparator(const char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',' || c == '\v' || c == '\f';
+}
+
+BatchInput::BatchInput(const std::string& path) {
+    if (path == "-") fd = STDIN_FILENO;
+    else {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        ownsFd = true;
+    }
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) == 0 && S_ISREG(fileInfo.st_mode)) {
+        //an empty file has nothing to map, and nothing to parse either
+        if (!fileInfo.st_size) {
+            endOfInput = true;
+            return;
+        }
+        void* mapping { mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0) };
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, fileInfo.st_size, MADV_SEQUENTIAL);
+            mappedFile = mappedCursor = static_cast<const char*>(mapping);
+            mappedFileSize = fileInfo.st_size;
+            return;
+        }
+    }
+    buffer.resize(blockSize);
+}
+
+BatchInput::~BatchInput() {
+    if (mappedFile) munmap(const_cast<char*>(mappedFile), mappedFileSize);
+    if (ownsFd) close(fd);
+}
+
+bool BatchInput::nextBatch(std::vector<uint64_t>& batch, const size_t maxCount) {
+    batch.clear();
+    if (mappedFile) 
+        mappedCursor = parseTokens(mappedCursor, mappedFile + mappedFileSize, true, batch, maxCount);
+    else for (;;) {
+        const char* const stopped { parseTokens(buffer.data() + bufferBegin, buffer.data() + bufferEnd, endOfInput, batch, maxCount) };
+        bufferBegin = stopped - buffer.data();
+        if (batch.size() == maxCount || endOfInput) break;
+        refillBuffer();
+    }
+    return !batch.empty();
+}
+
+uint64_t BatchInput::getMaxCount(void) const {
+    //every number but the last is followed by at least one separator
+    return mappedFile ? (mappedFileSize + 1) / 2 : 0;
+}
+
+uint64_t BatchInput::getInvalidTokenCount(void) const {
+    return invalidTokenCount;
+}
+
+const char* BatchInput::parseTokens(const char* pos, const char* const end, const bool final, std::vector<uint64_t>& batch, const size_t maxCount) {
+    while (batch.size() < maxCount) {
+        while (pos != end && isSeparator(*pos)) ++pos;
+        if (pos == end) break;
+
+        uint64_t n { 0 };
+        const auto [next, error] { std::from_chars(pos, end, n) };
+        if (error == std::errc() && next != end && isSeparator(*next)) {
+            batch.push_back(n);
+            pos = next;
+            continue;
+        }
+        //the token may continue in input not yet read
+        const char* const tokenEnd { std::find_if(next, end, isSeparator) };
+        if (tokenEnd == end && !final) break;
+        if (error == std::errc() && next == tokenEnd) batch.push_back(n);
+        else ++invalidTokenCount;
+        pos = tokenEnd;
+    }
+    return pos;
+}
+
+void BatchInput::refillBuffer(void) {
+    std::memmove(buffer.data(), buffer.data() + bufferBegin, bufferEnd - bufferBegin);
+    bufferEnd -= bufferBegin;
+    bufferBegin = 0;
+    //a single token longer than the buffer
+    if (bufferEnd == buffer.size()) buffer.resize(2 * buffer.size());
+
+    ssize_t bytesRead;
+    do bytesRead = read(fd, buffer.data() + bufferEnd, buffer.size() - bufferEnd);
+    while (bytesRead < 0 && errno == EINTR);
+    if (bytesRead <= 0) endOfInput = true;
+    else bufferEnd += bytesRead;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//reads whitespace or comma separated decimal numbers for batch mode, a batch at a time
+//regular files are memory mapped and parsed in place; anything else (e.g. stdin, given as "-") is read in large blocks
+//tokens that are not numbers below 2^64 are skipped and counted
+class BatchInput {
+public:
+    //throws std::runtime_error if path cannot be opened
+    BatchInput(const std::string& path);
+    ~BatchInput();
+    BatchInput(const BatchInput&) = delete;
+    BatchInput& operator=(const BatchInput&) = delete;
+
+    //replaces the contents of batch with up to maxCount of the next numbers, returning false once the input is exhausted
+    bool nextBatch(std::vector<uint64_t>& batch, const size_t maxCount);
+
+    //an upper bound on the number of numbers in the input, or 0 if unknown (e.g. for stdin)
+    uint64_t getMaxCount(void) const;
+    uint64_t getInvalidTokenCount(void) const;
+
+    //bytes read from unmapped input at a time
+    static constexpr size_t blockSize = 1u << 20;
+
+private:
+    //parses whole tokens from [pos, end) into batch until it holds maxCount numbers, returning where parsing stopped
+    //unless final, a token running into end is left unparsed, as the rest of it may not have been read yet
+    const char* parseTokens(const char* pos, const char* const end, const bool final, std::vector<uint64_t>& batch, const size_t maxCount);
+    //moves unparsed input to the front of buffer and reads more after it, setting endOfInput if there is none
+    void refillBuffer(void);
+
+    int fd = -1;
+    bool ownsFd = false;
+
+    const char* mappedFile = nullptr;
+    size_t mappedFileSize = 0;
+    //position of the next unparsed character in mappedFile
+    const char* mappedCursor = nullptr;
+
+    std::vector<char> buffer;
+    //unparsed characters of buffer are [bufferBegin, bufferEnd)
+    size_t bufferBegin = 0, bufferEnd = 0;
+    bool endOfInput = false;
+
+    uint64_t invalidTokenCount = 0;
+};
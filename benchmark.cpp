@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <print>
+#include <string_view>
+#include <vector>
+#include "batchgcd.hpp"
+#include "benchmarkutils.hpp"
+#include "calculationinfo.hpp"
+#include "fastdivisor.hpp"
+#include "interleavedfactorization.hpp"
+#include "primes.hpp"
+#include "splitmix64.hpp"
+#include "statset.hpp"
+#include "tieredfactorization.hpp"
+#include "trialkernel.hpp"
+#include "utils.hpp"
+#include "workloads.hpp"
+
+//microbenchmarks for individual components of the calculator
+//usage: primeFactorBench.exe [benchmark name...], running every benchmark if none are named
+
+//compares primes tested per nanosecond between the trial division kernel's instruction sets and the scalar division loops it replaces
+void benchmarkTrialKernel(void) {
+    printDivider("Trial Division Kernel");
+    //the greatest 64 bit prime, so every candidate divisor is tested
+    static constexpr uint64_t n = 18446744073709551557ull;
+    const std::vector<uint8_t> halfGaps { primes::getPrimeTable().viewHalfGaps().begin(), primes::getPrimeTable().viewHalfGaps().end() };
+
+    const auto report = [](const std::string_view name, const uint64_t divisorsTested, const std::chrono::duration<long double, std::nano> time) {
+        std::println("{:{}}{:.3f} primes/ns ({} divisors in {})", name, miniPanelWidth, divisorsTested / time.count(), divisorsTested, time);
+    };
+
+    //the loop formerly used by primes::isPrime, which tests every odd non multiple of 3
+    const auto legacyTime { timePerCall([&]{
+        bool divisible { false };
+        for (uint64_t i { 5 }; i < TrialDivisionKernel::kernelBound; i += 2) {
+            if (i % 3 == 0) i += 2;
+            divisible |= n % i == 0;
+        }
+        doNotOptimize(divisible);
+    }) };
+    //the kernel only tests primes, so the legacy loop is credited with the same number of primes for comparison
+    report("Legacy isPrime loop (n % i):", TrialDivisionKernel().getPrimeCount(), legacyTime);
+
+    //the prime table walk the kernel replaces as the small factor stage
+    const size_t tablePrimeCount { std::min(TrialDivisionKernel().getPrimeCount(), halfGaps.size()) };
+    const auto tableTime { timePerCall([&]{
+        bool divisible { false };
+        uint64_t divisor { 1 };
+        for (size_t i { 0 }; i < tablePrimeCount; ++i) {
+            divisor += 2u * halfGaps[i];
+            divisible |= n % divisor == 0;
+        }
+        doNotOptimize(divisible);
+    }) };
+    report("Prime table walk (n % p):", tablePrimeCount, tableTime);
+
+    static constexpr std::pair<TrialDivisionKernel::InstructionSet, std::string_view> instructionSets[] {
+        { TrialDivisionKernel::InstructionSet::SCALAR, "Kernel, scalar" },
+        { TrialDivisionKernel::InstructionSet::AVX2,   "Kernel, AVX2" },
+        { TrialDivisionKernel::InstructionSet::AVX512, "Kernel, AVX-512" }
+    };
+    //the 32 bit kernel is given the greatest 32 bit prime, which likewise has no divisor in the kernel's range
+    const auto benchmarkKernel = [&]<class Word>(const Word prime, const std::string_view widthName) {
+        for (const auto& [instructionSet, name] : instructionSets) {
+            const BasicTrialDivisionKernel<Word> kernel(static_cast<typename BasicTrialDivisionKernel<Word>::InstructionSet>(instructionSet));
+            const std::string label { std::format("{} {}:", name, widthName) };
+            if (static_cast<TrialDivisionKernel::InstructionSet>(kernel.getInstructionSet()) != instructionSet) {
+                std::println("{:{}}unsupported on this CPU", label, miniPanelWidth);
+                continue;
+            }
+            const auto kernelTime { timePerCall([&]{ doNotOptimize(kernel.findDivisor(prime, 0, std::numeric_limits<uint64_t>::max())); }) };
+            report(label, kernel.getPrimeCount(), kernelTime);
+        }
+    };
+    benchmarkKernel(n, "(64 bit)");
+    benchmarkKernel(static_cast<uint32_t>(4294967291u), "(32 bit)");
+}
+
+//compares divisibility tests by primes beyond the kernel's range between hardware division and FastDivisor,
+//both constructing each FastDivisor per use, as wheel candidates beyond the prime table would need, and with the inverses PrimeTable caches
+void benchmarkFastDivisor(void) {
+    printDivider("Fast Divisor");
+    static constexpr uint64_t n = 18446744073709551557ull;
+    static constexpr size_t divisorCount = 1 << 14;
+    std::vector<uint64_t> divisors;
+    divisors.reserve(divisorCount);
+    //the default prime table stops at the kernel bound too, so the primes just beyond it are found directly
+    for (uint64_t divisor { primes::smallFastDivisorBound + 1 }; divisors.size() < divisorCount; divisor += 2)
+        if (primes::isPrimeMillerRabin(divisor)) divisors.push_back(divisor);
+
+    const auto report = [](const std::string_view name, const std::chrono::duration<long double, std::nano> time) {
+        std::println("{:{}}{:.3f} ns/divisor", name, miniPanelWidth, time.count() / divisorCount);
+    };
+
+    report("Hardware division (n % p):", timePerCall([&]{
+        bool divisible { false };
+        for (const uint64_t d : divisors) divisible |= n % d == 0;
+        doNotOptimize(divisible);
+    }));
+    report("FastDivisor, constructed per use:", timePerCall([&]{
+        bool divisible { false };
+        for (const uint64_t d : divisors) divisible |= FastDivisor(d).divides(n);
+        doNotOptimize(divisible);
+    }));
+    std::vector<FastDivisor> fastDivisors { divisors.begin(), divisors.end() };
+    report("FastDivisor, precomputed:", timePerCall([&]{
+        bool divisible { false };
+        for (const FastDivisor& d : fastDivisors) divisible |= d.divides(n);
+        doNotOptimize(divisible);
+    }));
+}
+
+//times each tier's strategy alone on balanced semiprimes (the hardest inputs for every strategy) across bit widths,
+//alongside the tiered engine with the current crossovers, to justify the default crossovers
+void benchmarkTierSweep(void) {
+    printDivider("Tier Crossover Sweep (us per balanced semiprime)");
+    static constexpr size_t inputsPerWidth = 64;
+    //strategies are skipped above their maximum width, and trial division above the point where it takes seconds per width
+    static constexpr unsigned maxTrialDivisionSweepBits = 40;
+
+    struct Strategy {
+        std::string_view name;
+        primes::Engine engine;
+        primes::TierCrossovers crossovers;
+        unsigned maxBits;
+    };
+    const primes::TierCrossovers defaults { primes::getTierCrossovers() };
+    const Strategy strategies[] {
+        { "Trial",    primes::Engine::TRIAL_DIVISION, defaults, maxTrialDivisionSweepBits },
+        { "OLF",      primes::Engine::TIERED, { 0, primes::TierCrossovers::maxOneLineBits, 0 }, primes::TierCrossovers::maxOneLineBits },
+        { "SQUFOF",   primes::Engine::TIERED, { 0, 0, primes::TierCrossovers::maxSqufofBits }, primes::TierCrossovers::maxSqufofBits },
+        { "Rho",      primes::Engine::TIERED, { 0, 0, 0 }, 64 },
+        { "Tiered",   primes::Engine::TIERED, defaults, 64 }
+    };
+
+    std::print("{:>6}", "Bits");
+    for (const Strategy& strategy : strategies) std::print("{:>12}", strategy.name);
+    std::println("");
+
+    for (unsigned bits { 20 }; bits <= 64; bits += 2) {
+        const std::vector<uint64_t> inputs { generateWorkload(Workload::BALANCED_SEMIPRIME, bits, inputsPerWidth, bits) };
+
+        std::print("{:>6}", bits);
+        for (const Strategy& strategy : strategies) {
+            if (bits > strategy.maxBits) {
+                std::print("{:>12}", "-");
+                continue;
+            }
+            primes::setTierCrossovers(strategy.crossovers);
+            size_t i { 0 };
+            const auto time { timePerCall([&]{ doNotOptimize(primes::primeFactorization(inputs[i++ % inputsPerWidth], strategy.engine)); }, std::chrono::milliseconds(50)) };
+            std::print("{:>12.3f}", time.count() / 1000);
+        }
+        std::println("");
+    }
+    primes::setTierCrossovers(defaults);
+}
+
+//compares trial division beyond the prime table's bound between wheel sizes, then factorization of inputs below 2^16 between
+//the compile time smallest factor table and the trial division kernel
+void benchmarkWheel(void) {
+    printDivider("Wheel Trial Division (ms per prime)");
+    //primes whose every wheel candidate from smallFastDivisorBound through their square root is tried
+    static constexpr uint64_t wheelPrimes[] { 17592186044399ull, 1125899906842597ull };
+
+    const auto timeWheel = [&]<size_t wheelBasisSize>(const uint64_t prime) {
+        return timePerCall([&]{
+            uint64_t n { prime };
+            Factorization found;
+            doNotOptimize(primes::divideOutWheelCandidates<wheelBasisSize>(n, found, primes::smallFastDivisorBound));
+        }).count() / 1e6;
+    };
+    std::println("{:<24}{:>12}{:>12}{:>12}{:>12}{:>12}", "Prime", "mod 2", "mod 6", "mod 30", "mod 210", "mod 2310");
+    for (const uint64_t prime : wheelPrimes) {
+        std::println("{:<24}{:>12.3f}{:>12.3f}{:>12.3f}{:>12.3f}{:>12.3f}", prime, timeWheel.template operator()<1>(prime), timeWheel.template operator()<2>(prime), 
+            timeWheel.template operator()<3>(prime), timeWheel.template operator()<4>(prime), timeWheel.template operator()<5>(prime));
+    }
+
+    printDivider("Inputs Below 2^16 (ns per input)");
+    const auto perInput = [](const std::function<void(const uint32_t)>& factor) {
+        return timePerCall([&]{ for (uint32_t n { 0 }; n < primes::smallFastDivisorBound; ++n) factor(n); }).count() / primes::smallFastDivisorBound;
+    };
+    std::println("{:{}}{:.2f}", "Smallest factor table:", miniPanelWidth, perInput([](const uint32_t n){ doNotOptimize(primes::primeFactorization(n)); }));
+    std::println("{:{}}{:.2f}", "Trial division kernel:", miniPanelWidth, perInput([](const uint32_t n){ doNotOptimize(primes::trialDivisionFactorization(n)); }));
+}
+
+//amortized cost per input of batch gcd against handling each input alone, first for splitting off every factor below primes::batchGcdBound
+//(compared with a trial division pass to the same bound), then for complete factorization with the tiered engine
+void benchmarkBatchGcd(void) {
+    printDivider("Batch GCD (ns per input)");
+    static constexpr size_t batchSizes[] { 1 << 8, 1 << 12 };
+    static constexpr Workload batchWorkloads[] { Workload::UNIFORM, Workload::SMOOTH };
+
+    std::println("{:<12}{:>10}{:>16}{:>16}{:>16}{:>16}", "Workload", "Batch", "Trial to bound", "Smooth parts", "Tiered", "Batch + tiered");
+    for (const Workload workload : batchWorkloads) {
+        for (const size_t batchSize : batchSizes) {
+            const std::vector<uint64_t> inputs { generateWorkload(workload, 64, batchSize, batchSize) };
+            std::vector<uint64_t> smoothParts(batchSize);
+            std::vector<Factorization> factorizations(batchSize);
+            const auto perInput = [&](const std::function<void(void)>& f) { return timePerCall(f).count() / batchSize; };
+
+            const long double trialTime { perInput([&]{
+                for (const uint64_t n : inputs) {
+                    uint64_t odd { n >> std::countr_zero(n) };
+                    Factorization found;
+                    primes::divideOutTablePrimes(odd, found, primes::batchGcdBound);
+                    doNotOptimize(odd);
+                }
+            }) };
+            const long double smoothTime { perInput([&]{
+                primes::batchSmoothParts(inputs, smoothParts);
+                doNotOptimize(smoothParts.data());
+            }) };
+            const long double tieredTime { perInput([&]{ for (const uint64_t n : inputs) doNotOptimize(primes::primeFactorization(n, primes::Engine::TIERED)); }) };
+            const long double batchTime { perInput([&]{
+                primes::batchGcdFactorization(inputs, factorizations, primes::Engine::TIERED);
+                doNotOptimize(factorizations.data());
+            }) };
+            std::println("{:<12}{:>10}{:>16.1f}{:>16.1f}{:>16.1f}{:>16.1f}", workloadName(workload), batchSize, trialTime, smoothTime, tieredTime, batchTime);
+        }
+    }
+}
+
+//time per input of the tiered engine one input at a time against primes::factorBatch at each lane count
+void benchmarkInterleaved(void) {
+    printDivider("Interleaved Factorization (ns per input)");
+    static constexpr size_t batchSize = 64;
+    struct InterleavedWorkload {
+        Workload workload;
+        unsigned bits;
+    };
+    static constexpr InterleavedWorkload interleavedWorkloads[] { 
+        { Workload::BALANCED_SEMIPRIME, 44 }, { Workload::BALANCED_SEMIPRIME, 64 }, { Workload::PRIME, 64 }, { Workload::UNIFORM, 64 } 
+    };
+
+    std::println("{:<20}{:>6}{:>12}{:>12}{:>12}{:>12}", "Workload", "Bits", "Tiered", "4 lanes", "8 lanes", "16 lanes");
+    for (const auto [workload, bits] : interleavedWorkloads) {
+        const std::vector<uint64_t> inputs { generateWorkload(workload, bits, batchSize, bits) };
+        std::vector<Factorization> factorizations(batchSize);
+        const auto perInput = [&](const std::function<void(void)>& f) { return timePerCall(f).count() / batchSize; };
+        const auto batchTime = [&]<size_t laneCount>() { 
+            return perInput([&]{
+                primes::factorBatch<laneCount>(inputs, factorizations);
+                doNotOptimize(factorizations.data());
+            });
+        };
+
+        const long double tieredTime { perInput([&]{ for (const uint64_t n : inputs) doNotOptimize(primes::primeFactorization(n, primes::Engine::TIERED)); }) };
+        std::println("{:<20}{:>6}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}", workloadName(workload), bits, tieredTime, 
+            batchTime.template operator()<4>(), batchTime.template operator()<8>(), batchTime.template operator()<16>());
+    }
+}
+
+//counts heap allocations per input at each stage of the calculator's per input pipeline
+//with the earlier vector backed Factorization, the stages below measured 1, 2 and 3.41 allocations per input
+void benchmarkAllocations(void) {
+    printDivider("Allocations per Factorization");
+    static constexpr size_t inputCount = 1 << 16;
+    static constexpr size_t warmupCount = 1 << 8;
+    std::vector<uint64_t> inputs(inputCount), warmupInputs(warmupCount);
+    SplitMix64 gen(0);
+    for (uint64_t& n : inputs) n = gen();
+    for (uint64_t& n : warmupInputs) n = gen();
+
+    const auto report = [](const std::string_view name, const uint64_t allocations) {
+        std::println("{:{}}{:.4f}", name, miniPanelWidth, static_cast<long double>(allocations) / inputCount);
+    };
+    //a few other inputs are processed beforehand so that one time setup (e.g. the prime table) is not counted
+    const auto allocationsDuring = [&](const std::function<void(const uint64_t)>& process) {
+        for (const uint64_t n : warmupInputs) process(n);
+        const uint64_t before { getAllocationCount() };
+        for (const uint64_t n : inputs) process(n);
+        return getAllocationCount() - before;
+    };
+
+    report("primeFactorization:", allocationsDuring([](const uint64_t n){ doNotOptimize(primes::primeFactorization(n, primes::Engine::TIERED)); }));
+    report("FactorCalculationInfo, timed:", allocationsDuring([](const uint64_t n){
+        FactorCalculationInfo infoSet { n };
+        infoSet.calculateAndTime(primes::Engine::TIERED);
+        doNotOptimize(infoSet);
+    }));
+    //includes recording every prime factor found into the set's factor counts, which allocates for primes not yet seen
+    StatSet stats(inputCount);
+    report("Recorded in a StatSet:", allocationsDuring([&](const uint64_t n){
+        FactorCalculationInfo infoSet { n };
+        infoSet.calculateAndTime(primes::Engine::TIERED);
+        stats.handleNewFactorizationData(std::move(infoSet));
+    }));
+}
+
+int main(int argc, char** argv) {
+    static const std::pair<std::string_view, std::function<void(void)>> benchmarks[] {
+        { "trial-kernel", benchmarkTrialKernel },
+        { "fast-divisor", benchmarkFastDivisor },
+        { "tier-sweep", benchmarkTierSweep },
+        { "allocations", benchmarkAllocations },
+        { "batch-gcd", benchmarkBatchGcd },
+        { "interleaved", benchmarkInterleaved },
+        { "wheel", benchmarkWheel }
+    };
+
+    for (const auto& [name, benchmark] : benchmarks)
+        if (argc < 2 || std::find(argv + 1, argv + argc, name) != argv + argc) benchmark();
+    return 0;
+}
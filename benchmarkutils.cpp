@@ -0,0 +1,29 @@
+#include "benchmarkutils.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocationCount { 0 };
+
+void* operator new(const std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p { std::malloc(size ? size : 1) }) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+uint64_t getAllocationCount(void) {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+std::chrono::duration<long double, std::nano> timePerCall(const std::function<void(void)>& f, const std::chrono::milliseconds minDuration) {
+    uint64_t calls { 0 };
+    const auto start { std::chrono::steady_clock::now() };
+    std::chrono::steady_clock::duration elapsed;
+    //checks the clock only every so often so that its own overhead is negligible
+    do {
+        for (int i = 0; i < 64; ++i, ++calls) f();
+    } while ((elapsed = std::chrono::steady_clock::now() - start) < minDuration);
+    return std::chrono::duration<long double, std::nano>(elapsed) / calls;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+//helpers shared by the benchmark executables, which also link benchmarkutils.cpp's counting replacement of operator new
+
+//prevents the compiler from discarding a result that is otherwise unused
+template<class T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+//every allocation made through operator new anywhere in the executable so far
+uint64_t getAllocationCount(void);
+
+//calls f repeatedly for at least minDuration, returning the mean time per call
+std::chrono::duration<long double, std::nano> timePerCall(const std::function<void(void)>& f, const std::chrono::milliseconds minDuration = std::chrono::milliseconds(250));
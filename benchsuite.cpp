@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+#include "benchmarkutils.hpp"
+#include "latencyhistogram.hpp"
+#include "primes.hpp"
+#include "splitmix64.hpp"
+#include "tscclock.hpp"
+#include "utils.hpp"
+#include "workloads.hpp"
+
+//reproducible benchmark of every engine against every workload class, for telling whether a change to primes::primeFactorization helped
+//inputs are generated from the seed alone, so two runs with the same seed factor exactly the same numbers
+static constexpr const char* usage =
+    "usage: primeFactorSuite.exe [--json <path, or - for stdout>] [--compare <baseline json>] [--threshold <percent>] [--trials <count>] [--seed <seed>]\n"
+    "factors seeded inputs of each workload class with each engine, reporting throughput, p50/p99 latency and allocations per input\n"
+    "--compare flags every case that regressed by more than --threshold percent (default 10) against a file previously written by --json,\n"
+    "and exits with status 2 if any did";
+
+struct SuiteCase {
+    primes::Engine engine;
+    std::string_view engineName;
+    Workload workload;
+    unsigned bits;
+
+    //e.g. "tiered/semiprime/64"
+    std::string getName(void) const { return std::format("{}/{}/{}", engineName, workloadName(workload), bits); }
+};
+
+struct CaseResult {
+    std::string name;
+    //inputs per second, the best across trials, as interference from the rest of the system only ever slows a trial down
+    long double throughput;
+    long double p50Ns, p99Ns;
+    long double allocationsPerInput;
+};
+
+//inputs per case, factored for a warmup, then some number of times per trial for throughput, and once more per trial for latencies
+static constexpr size_t inputsPerCase = 1024;
+//least time spent warming up each case, and so spent on each trial's throughput measurement
+static constexpr std::chrono::milliseconds minTrialTime { 20 };
+//trial division is skipped above this width, where a single hard input takes milliseconds or more
+static constexpr unsigned maxTrialDivisionBits = 40;
+
+static std::vector<SuiteCase> listCases(void) {
+    static constexpr std::pair<primes::Engine, std::string_view> engines[] {
+        { primes::Engine::TRIAL_DIVISION, "trial" },
+        { primes::Engine::POLLARD_RHO,    "rho" },
+        { primes::Engine::TIERED,         "tiered" }
+    };
+    static constexpr std::pair<Workload, unsigned> classes[] {
+        { Workload::BALANCED_SEMIPRIME, 24 }, { Workload::BALANCED_SEMIPRIME, 32 }, { Workload::BALANCED_SEMIPRIME, 40 },
+        { Workload::BALANCED_SEMIPRIME, 48 }, { Workload::BALANCED_SEMIPRIME, 56 }, { Workload::BALANCED_SEMIPRIME, 64 },
+        { Workload::PRIME, 32 }, { Workload::PRIME, 64 },
+        { Workload::PRIME_POWER, 64 },
+        { Workload::SMOOTH, 64 },
+        { Workload::UNIFORM, 32 }, { Workload::UNIFORM, 64 }
+    };
+
+    std::vector<SuiteCase> cases;
+    for (const auto& [engine, engineName] : engines)
+        for (const auto& [workload, bits] : classes) {
+            //smooth inputs have no factor beyond the smallest primes, so trial division handles them at any width
+            if (engine == primes::Engine::TRIAL_DIVISION && workload != Workload::SMOOTH && bits > maxTrialDivisionBits) continue;
+            cases.push_back({ engine, engineName, workload, bits });
+        }
+    return cases;
+}
+
+static CaseResult runCase(const SuiteCase& suiteCase, const unsigned trials, const uint64_t seed) {
+    //every engine is given the same inputs for a given class and width
+    const std::vector<uint64_t> inputs { generateWorkload(suiteCase.workload, suiteCase.bits, inputsPerCase, SplitMix64(seed).split(static_cast<uint64_t>(suiteCase.workload) * 64 + suiteCase.bits)()) };
+    const auto factorAll = [&]{ for (const uint64_t n : inputs) doNotOptimize(primes::primeFactorization(n, suiteCase.engine)); };
+
+    //warms up for at least minTrialTime, and repeats the inputs in each trial as many times as that took, so that fast cases are not lost in noise
+    uint64_t passesPerTrial { 0 };
+    const uint64_t warmupStart { TscClock::start() };
+    do {
+        factorAll();
+        ++passesPerTrial;
+    } while (TscClock::ticksToNanos(TscClock::stop() - warmupStart) < std::chrono::duration<long double, std::nano>(minTrialTime).count());
+
+    std::vector<long double> throughputs;
+    LatencyHistogram latencies;
+    uint64_t allocations { 0 };
+    for (unsigned trial { 0 }; trial < trials; ++trial) {
+        //throughput is measured over whole passes, free of per input timer overhead
+        const uint64_t allocationsBefore { getAllocationCount() };
+        const uint64_t start { TscClock::start() };
+        for (uint64_t pass { 0 }; pass < passesPerTrial; ++pass) factorAll();
+        const uint64_t trialTicks { TscClock::stop() - start };
+        allocations += getAllocationCount() - allocationsBefore;
+        throughputs.push_back(passesPerTrial * inputs.size() / (TscClock::ticksToNanos(std::max<uint64_t>(trialTicks, 1)) / 1e9L));
+
+        //then latencies, input by input
+        for (const uint64_t n : inputs) {
+            const uint64_t inputStart { TscClock::start() };
+            doNotOptimize(primes::primeFactorization(n, suiteCase.engine));
+            latencies.record(std::llround(TscClock::ticksToNanos(TscClock::stop() - inputStart)));
+        }
+    }
+    return { suiteCase.getName(), std::ranges::max(throughputs),
+        latencies.valueAtQuantile(.5), latencies.valueAtQuantile(.99),
+        static_cast<long double>(allocations) / (trials * passesPerTrial * inputs.size()) };
+}
+
+//one case per line, which readBaseline relies on
+static void writeJson(const std::vector<CaseResult>& results, const unsigned trials, const uint64_t seed, FILE* outStream) {
+    std::println(outStream, "{{");
+    std::println(outStream, "  \"seed\": {},", seed);
+    std::println(outStream, "  \"trials\": {},", trials);
+    std::println(outStream, "  \"inputsPerCase\": {},", inputsPerCase);
+    std::println(outStream, "  \"timer\": \"{}\",", TscClock::describeSource());
+    std::println(outStream, "  \"cases\": [");
+    for (size_t i { 0 }; i < results.size(); ++i) {
+        const CaseResult& result { results[i] };
+        std::println(outStream, "    {{\"name\": \"{}\", \"throughput\": {:.1f}, \"p50Ns\": {:.1f}, \"p99Ns\": {:.1f}, \"allocationsPerInput\": {:.4f}}}{}",
+            result.name, result.throughput, result.p50Ns, result.p99Ns, result.allocationsPerInput, i + 1 < results.size() ? "," : "");
+    }
+    std::println(outStream, "  ]");
+    std::println(outStream, "}}");
+}
+
+//the value following "key": in line, if any
+static std::optional<std::string_view> findField(const std::string_view line, const std::string_view key) {
+    const std::string quotedKey { std::format("\"{}\":", key) };
+    size_t position { line.find(quotedKey) };
+    if (position == std::string_view::npos) return std::nullopt;
+    position = line.find_first_not_of(' ', position + quotedKey.size());
+    if (position == std::string_view::npos) return std::nullopt;
+    if (line[position] == '"') {
+        const size_t end { line.find('"', position + 1) };
+        if (end == std::string_view::npos) return std::nullopt;
+        return line.substr(position + 1, end - position - 1);
+    }
+    return line.substr(position, line.find_first_of(",}", position) - position);
+}
+
+//reads the cases of a file written by writeJson; not a general JSON parser
+static std::vector<CaseResult> readBaseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error(std::format("cannot open baseline \"{}\"", path));
+
+    const auto parseNumber = [&](const std::string_view line, const std::string_view key) {
+        const std::optional<std::string_view> text { findField(line, key) };
+        double value;
+        if (!text || std::from_chars(text->data(), text->data() + text->size(), value).ec != std::errc())
+            throw std::runtime_error(std::format("baseline \"{}\" has a case without a numeric \"{}\"", path, key));
+        return static_cast<long double>(value);
+    };
+
+    std::vector<CaseResult> results;
+    for (std::string line; std::getline(file, line);) {
+        const std::optional<std::string_view> name { findField(line, "name") };
+        if (!name) continue;
+        results.push_back({ std::string(*name), parseNumber(line, "throughput"), parseNumber(line, "p50Ns"), parseNumber(line, "p99Ns"), parseNumber(line, "allocationsPerInput") });
+    }
+    return results;
+}
+
+//prints each case's change from the baseline, returning the number of cases that regressed by more than thresholdPercent
+static size_t compareToBaseline(const std::vector<CaseResult>& results, const std::vector<CaseResult>& baseline, const long double thresholdPercent, FILE* outStream) {
+    printDivider(std::format("Comparison to Baseline (threshold {}%)", thresholdPercent), outStream);
+    std::println(outStream, "{:28}{:>22}{:>22}{:>22}{:>14}", "Case", "Throughput", "p50", "p99", "Allocations");
+    //percent change, positive when worse
+    const auto slowdown = [](const long double before, const long double after, const bool higherIsBetter) {
+        if (before == 0) return 0.L;
+        return 100 * (higherIsBetter ? before - after : after - before) / before;
+    };
+
+    size_t regressions { 0 };
+    for (const CaseResult& result : results) {
+        const auto match { std::ranges::find(baseline, result.name, &CaseResult::name) };
+        if (match == baseline.end()) {
+            std::println(outStream, "{:28}{:>22}", result.name, "(not in baseline)");
+            continue;
+        }
+        const long double changes[] {
+            slowdown(match->throughput, result.throughput, true),
+            slowdown(match->p50Ns, result.p50Ns, false),
+            slowdown(match->p99Ns, result.p99Ns, false)
+        };
+        //any new allocation on the factoring path is a regression, however small
+        const bool allocationRegressed { result.allocationsPerInput > match->allocationsPerInput + 1e-3L };
+        const bool regressed { allocationRegressed || std::ranges::any_of(changes, [&](const long double change){ return change > thresholdPercent; }) };
+        regressions += regressed;
+
+        //shown as the change in the measured value itself, e.g. -12% throughput or +12% p50 are both regressions
+        std::println(outStream, "{:28}{:>22}{:>22}{:>22}{:>14}{}", result.name,
+            std::format("{:.0f}/s ({:+.1f}%)", result.throughput, -changes[0]),
+            std::format("{:.0f}ns ({:+.1f}%)", result.p50Ns, changes[1]),
+            std::format("{:.0f}ns ({:+.1f}%)", result.p99Ns, changes[2]),
+            std::format("{:.4f}", result.allocationsPerInput),
+            regressed ? "  REGRESSION" : "");
+    }
+    std::println(outStream, "{} of {} cases regressed", regressions, results.size());
+    return regressions;
+}
+
+//parses a whole argument as a number
+template<class T>
+static T parseArgument(const std::string_view option, const std::string_view text) {
+    T value;
+    const auto [end, error] { std::from_chars(text.data(), text.data() + text.size(), value) };
+    if (error != std::errc() || end != text.data() + text.size())
+        throw std::invalid_argument(std::format("{} expects a number, not \"{}\"", option, text));
+    return value;
+}
+
+int main(int argc, char** argv) {
+    std::string jsonPath, baselinePath;
+    double thresholdPercent { 10 };
+    unsigned trials { 5 };
+    uint64_t seed { 0 };
+    try {
+        for (int i { 1 }; i < argc; ++i) {
+            const std::string_view option { argv[i] };
+            const auto value = [&]() -> std::string_view {
+                if (++i == argc) throw std::invalid_argument(std::format("{} expects a value", option));
+                return argv[i];
+            };
+            if (option == "--json") jsonPath = value();
+            else if (option == "--compare") baselinePath = value();
+            else if (option == "--threshold") thresholdPercent = parseArgument<double>(option, value());
+            else if (option == "--trials") trials = std::max(parseArgument<unsigned>(option, value()), 1u);
+            else if (option == "--seed") seed = parseArgument<uint64_t>(option, value());
+            else throw std::invalid_argument(std::format("unknown argument \"{}\"", option));
+        }
+    }
+    catch (const std::exception& e) {
+        std::println(stderr, "{}\n{}", e.what(), usage);
+        return 1;
+    }
+    //plain when the table itself is redirected, e.g. into a CI log
+    setPlainTextOutput(!isatty(STDOUT_FILENO) || jsonPath == "-");
+
+    TscClock::calibrate();
+    //loaded up front so that no case pays for sieving it
+    primes::getPrimeTable();
+
+    //the table goes to stderr instead when stdout carries the JSON
+    FILE* const tableStream { jsonPath == "-" ? stderr : stdout };
+    printDivider(std::format("Benchmark Suite (seed {}, {} trials of {} inputs per case)", seed, trials, inputsPerCase), tableStream);
+    std::println(tableStream, "{:28}{:>16}{:>14}{:>14}{:>14}", "Case", "Throughput", "p50", "p99", "Allocations");
+    std::vector<CaseResult> results;
+    for (const SuiteCase& suiteCase : listCases()) {
+        results.push_back(runCase(suiteCase, trials, seed));
+        const CaseResult& result { results.back() };
+        std::println(tableStream, "{:28}{:>16}{:>14}{:>14}{:>14.4f}", result.name, std::format("{:.0f}/s", result.throughput),
+            std::format("{:.0f}ns", result.p50Ns), std::format("{:.0f}ns", result.p99Ns), result.allocationsPerInput);
+        std::fflush(tableStream);
+    }
+
+    if (!jsonPath.empty()) {
+        FILE* const jsonFile { jsonPath == "-" ? stdout : std::fopen(jsonPath.c_str(), "w") };
+        if (!jsonFile) {
+            std::println(stderr, "cannot write \"{}\"", jsonPath);
+            return 1;
+        }
+        writeJson(results, trials, seed, jsonFile);
+        if (jsonFile != stdout) std::fclose(jsonFile);
+    }
+
+    if (!baselinePath.empty()) {
+        try {
+            if (compareToBaseline(results, readBaseline(baselinePath), thresholdPercent, tableStream)) return 2;
+        }
+        catch (const std::exception& e) {
+            std::println(stderr, "{}", e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
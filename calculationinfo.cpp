@@ -1,12 +1,17 @@
 #include "calculationinfo.hpp"
+#include "reportwriter.hpp"
 
-void FactorCalculationInfo::calculateAndTime(void) {
-    auto start { std::chrono::steady_clock::now() };
-    factorization = primes::primeFactorization(n);
-    calcTime = std::chrono::duration<long double, std::milli>(std::chrono::steady_clock::now() - start);
+template<class T>
+void BasicFactorCalculationInfo<T>::printPostCalcInfo(void) const {
+    ReportWriter& writer { ReportWriter::forThisThread() };
+    writer.report(*this);
+    writer.flush();
 }
 
-void FactorCalculationInfo::printPostCalcInfo(void) const {
-    std::println("{}\n{}\n", factorization.asString(), calcTime);
+std::string FactorRecord::formatFactorization(void) const {
+    //every engine finds the same factorization, so the fastest is used regardless of which one n was ranked with
+    return primes::primeFactorization(n, primes::Engine::TIERED).asString();
 }
 
+template struct BasicFactorCalculationInfo<uint64_t>;
+template struct BasicFactorCalculationInfo<unsigned __int128>;
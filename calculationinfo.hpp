@@ -2,22 +2,143 @@
 
 #include <cstdint>
 #include <chrono>
+#include <format>
 #include <print>
+#include <string>
+#include <type_traits>
+#include "factorcache.hpp"
 #include "factorization.hpp"
+#include "opcounter.hpp"
+#include "perfcounters.hpp"
 #include "primes.hpp"
+#include "tscclock.hpp"
 
 //used to store information on noteworthy factorizations for use in concluding statistical printouts
-struct FactorCalculationInfo {
-    FactorCalculationInfo(uint64_t n_) : n(n_) {} 
+//T is the unsigned integer type of n; see BasicFactorization
+template<class T>
+struct BasicFactorCalculationInfo {
+    BasicFactorCalculationInfo(T n_) : n(n_), calcTicks(TscClock::untimed) {} 
+    //placeholder for preallocated storage, e.g. the slots of a timing block
+    BasicFactorCalculationInfo() : n(0), calcTicks(0) {}
 
     //precondition: infoset.n is defined
     //postcondition: all fields of infoSet are correctly filled
-    void calculateAndTime(void);
+    //Width may be narrower than T when n is already known to fit in it (e.g. every n in a range below 2^32),
+    //which skips primeFactorization's own per input check
+    template<class Width = T>
+    void calculateAndTime(const primes::Engine engine = primes::Engine::TRIAL_DIVISION);
 
-    //prints factorization and calcTime
+    //as calculateAndTime, also counting hardware events with the calling thread's PerfCounters
+    //the counters are read outside of the timed interval, as each read is a system call
+    template<class Width = T>
+    void calculateTimeAndCount(const primes::Engine engine = primes::Engine::TRIAL_DIVISION);
+
+    //as calculateAndTime, but leaves calcTicks untimed, e.g. for inputs skipped by sampling or timed as part of a block
+    //in builds with COUNT_OPERATIONS defined, also fills operationCounts (which is then inside any timed interval)
+    template<class Width = T>
+    void calculate(const primes::Engine engine = primes::Engine::TRIAL_DIVISION);
+
+    bool isTimed(void) const { return calcTicks != TscClock::untimed; }
+    //precondition: isTimed()
+    std::chrono::duration<long double, std::milli> getCalcTime(void) const { return TscClock::ticksToDuration(calcTicks); }
+    bool isCacheHit(void) const { return cacheResult == CacheResult::MEMORY_HIT || cacheResult == CacheResult::STORE_HIT; }
+    //calcTime, or "cached" or "untimed"
+    std::string formatCalcTime(void) const { return isTimed() ? std::format("{}", getCalcTime()) : isCacheHit() ? "cached" : "untimed"; }
+
+    //prints n, its factorization, and calcTime
     void printPostCalcInfo(void) const;
 
+    T n;
+    BasicFactorization<T> factorization;
+    //TscClock ticks, including TscClock::getOverheadTicks, or TscClock::untimed
+    //cache hits are always untimed, so that they are kept out of the time statistics
+    uint64_t calcTicks;
+    //set by the caller where a FactorCache is in use
+    CacheResult cacheResult { CacheResult::UNCACHED };
+    //all 0 unless counted, see HardwareCounts::isCounted
+    HardwareCounts hardwareCounts;
+    #ifdef COUNT_OPERATIONS
+    OperationCounts operationCounts;
+    #endif
+};
+
+using FactorCalculationInfo = BasicFactorCalculationInfo<uint64_t>;
+using FactorCalculationInfo128 = BasicFactorCalculationInfo<unsigned __int128>;
+
+//what rankings keep of a FactorCalculationInfo: everything they rank by or print, except the factorization itself
+//only a handful of ranked inputs are ever printed, so their factorizations are recomputed then rather than copied into every slot
+//trivially copyable and 24 bytes, so ranking an input copies a fraction of a cache line
+struct FactorRecord {
+    FactorRecord() : n(0), calcTicks(0), factorCount(0), uniqueFactorCount(0), cacheResult(CacheResult::UNCACHED) {}
+    explicit FactorRecord(const FactorCalculationInfo& info) : 
+        n(info.n), calcTicks(info.calcTicks), 
+        factorCount(info.factorization.getFactorCount()), uniqueFactorCount(info.factorization.getUniqueFactorCount()), 
+        cacheResult(info.cacheResult) {}
+
+    bool isTimed(void) const { return calcTicks != TscClock::untimed; }
+    //precondition: isTimed()
+    std::chrono::duration<long double, std::milli> getCalcTime(void) const { return TscClock::ticksToDuration(calcTicks); }
+    bool isCacheHit(void) const { return cacheResult == CacheResult::MEMORY_HIT || cacheResult == CacheResult::STORE_HIT; }
+    //as FactorCalculationInfo::formatCalcTime
+    std::string formatCalcTime(void) const { return isTimed() ? std::format("{}", getCalcTime()) : isCacheHit() ? "cached" : "untimed"; }
+
+    //as BasicFactorization::asString, rebuilt by factoring n again
+    std::string formatFactorization(void) const;
+
     uint64_t n;
-    Factorization factorization;
-    std::chrono::duration<long double, std::milli> calcTime;
-};
\ No newline at end of file
+    //as FactorCalculationInfo::calcTicks
+    uint64_t calcTicks;
+    uint8_t factorCount, uniqueFactorCount;
+    //where the factorization came from
+    CacheResult cacheResult;
+};
+
+static_assert(std::is_trivially_copyable_v<FactorRecord> && sizeof(FactorRecord) == 24);
+
+//records for the rankings that also print an input's counts, which only those rankings pay to copy
+struct HardwareCountedRecord : FactorRecord {
+    HardwareCountedRecord() = default;
+    explicit HardwareCountedRecord(const FactorCalculationInfo& info) : FactorRecord(info), hardwareCounts(info.hardwareCounts) {}
+
+    HardwareCounts hardwareCounts;
+};
+
+#ifdef COUNT_OPERATIONS
+struct OperationCountedRecord : FactorRecord {
+    OperationCountedRecord() = default;
+    explicit OperationCountedRecord(const FactorCalculationInfo& info) : FactorRecord(info), operationCounts(info.operationCounts) {}
+
+    OperationCounts operationCounts;
+};
+#endif
+
+template<class T>
+template<class Width>
+void BasicFactorCalculationInfo<T>::calculateAndTime(const primes::Engine engine) {
+    const uint64_t start { TscClock::start() };
+    calculate<Width>(engine);
+    calcTicks = TscClock::stop() - start;
+}
+
+template<class T>
+template<class Width>
+void BasicFactorCalculationInfo<T>::calculateTimeAndCount(const primes::Engine engine) {
+    const PerfCounters& counters { PerfCounters::forThisThread() };
+    const HardwareCounts before { counters.read() };
+    calculateAndTime<Width>(engine);
+    hardwareCounts = counters.read() - before;
+}
+
+template<class T>
+template<class Width>
+void BasicFactorCalculationInfo<T>::calculate(const primes::Engine engine) {
+    #ifdef COUNT_OPERATIONS
+    //discards anything counted outside of a factorization, e.g. by another caller of primes::
+    OperationCounter::take();
+    #endif
+    if constexpr (sizeof(Width) == sizeof(T)) factorization = primes::primeFactorization(n, engine);
+    else factorization = BasicFactorization<T>(primes::primeFactorization(static_cast<Width>(n), engine));
+    #ifdef COUNT_OPERATIONS
+    operationCounts = OperationCounter::take();
+    #endif
+}
@@ -0,0 +1,217 @@
+#include "factorcache.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "primes.hpp"
+
+//fibonacci hashing, taking the high bits, which depend on every bit of n
+static uint64_t hashIndex(const uint64_t n, const uint64_t mask) {
+    return ((n * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+bool CompactFactorization::pack(const uint64_t n_, const Factorization& factorization) {
+    n = n_;
+    ready = 0;
+    primes.fill(0);
+    size_t count { 0 };
+    for (const auto& [base, exp] : factorization.viewFactors()) {
+        if (base > std::numeric_limits<uint32_t>::max()) break;
+        if (count == primes.size()) return false;
+        primes[count++] = static_cast<uint32_t>(base);
+    }
+    ready = 1;
+    return true;
+}
+
+bool CompactFactorization::unpack(Factorization& factorization, const bool verifyPrimes) const {
+    factorization = Factorization();
+    uint64_t m { n };
+    uint32_t previous { 0 };
+    for (const uint32_t p : primes) {
+        if (!p) break;
+        //pack stores distinct primes in ascending order, so anything else was not written by it
+        if (p <= previous || (verifyPrimes && !primes::isPrimeMillerRabin(p))) return false;
+        previous = p;
+        uint_fast8_t exp { 0 };
+        for (; m % p == 0; ++exp) m /= p;
+        if (!exp) return false;
+        factorization.addNewFactor(p, exp);
+    }
+    //n has at most one prime factor above 2^32, as the square of any such prime exceeds 2^64, so whatever is left must be it
+    if (m > std::numeric_limits<uint32_t>::max()) {
+        if (verifyPrimes && !primes::isPrimeMillerRabin(m)) return false;
+        factorization.addNewFactor(m, 1);
+    }
+    else if (m != 1) return false;
+    return true;
+}
+
+FactorStore::FactorStore(const std::string& path, const uint64_t slotCount_) {
+    int fd { open(path.c_str(), O_RDWR) };
+    if (fd < 0 && errno != ENOENT) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+
+    struct stat fileInfo;
+    if (fd >= 0 && fstat(fd, &fileInfo) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+    }
+    if (fd < 0 || !fileInfo.st_size) {
+        const bool replaceEmpty { fd >= 0 };
+        if (replaceEmpty) close(fd);
+        fd = createTable(path, slotCount_, replaceEmpty);
+        if (fstat(fd, &fileInfo) != 0) {
+            close(fd);
+            throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+        }
+    }
+    header fileHeader;
+    if (pread(fd, &fileHeader, sizeof(fileHeader), 0) != sizeof(fileHeader) || std::memcmp(fileHeader.magic, storeMagic, sizeof(storeMagic))
+        || !std::has_single_bit(fileHeader.slotCount) || static_cast<uint64_t>(fileInfo.st_size) != sizeof(header) + fileHeader.slotCount * sizeof(CompactFactorization)) {
+        close(fd);
+        throw std::runtime_error(path + " is not a factorization cache");
+    }
+
+    mappedFileSize = fileInfo.st_size;
+    void* mapping { mmap(nullptr, mappedFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+    close(fd);
+    if (mapping == MAP_FAILED) throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+    mappedFile = mapping;
+    slotCount = fileHeader.slotCount;
+    slots = reinterpret_cast<CompactFactorization*>(static_cast<char*>(mappedFile) + sizeof(header));
+}
+
+int FactorStore::createTable(const std::string& path, const uint64_t slotCount_, const bool replaceEmpty) {
+    //written in full under a temporary name in the same directory before appearing at path, so no process ever maps a table
+    //whose header is still unwritten
+    std::string tempPath { path + ".XXXXXX" };
+    const int fd { mkstemp(tempPath.data()) };
+    if (fd < 0) throw std::runtime_error("cannot create " + path + ": " + std::strerror(errno));
+    const auto fail = [&](const std::string& step) {
+        const std::string reason { "cannot " + step + " " + path + ": " + std::strerror(errno) };
+        close(fd);
+        unlink(tempPath.c_str());
+        throw std::runtime_error(reason);
+    };
+
+    header fileHeader;
+    std::memset(&fileHeader, 0, sizeof(fileHeader));
+    std::memcpy(fileHeader.magic, storeMagic, sizeof(storeMagic));
+    fileHeader.slotCount = std::bit_ceil(std::max(slotCount_, uint64_t { maxProbes }));
+    //mkstemp creates the file readable by its owner only, but the table is meant to be shared
+    if (fchmod(fd, 0644) != 0 || ftruncate(fd, sizeof(header) + fileHeader.slotCount * sizeof(CompactFactorization)) != 0
+        || pwrite(fd, &fileHeader, sizeof(fileHeader), 0) != sizeof(fileHeader)) fail("create");
+
+    //an empty file holds no entries, so is simply replaced; otherwise link fails rather than replace a table
+    //another process created first, and that table is opened instead
+    if (replaceEmpty) {
+        if (rename(tempPath.c_str(), path.c_str()) != 0) fail("create");
+        return fd;
+    }
+    if (link(tempPath.c_str(), path.c_str()) == 0) {
+        unlink(tempPath.c_str());
+        return fd;
+    }
+    if (errno != EEXIST) fail("create");
+    close(fd);
+    unlink(tempPath.c_str());
+    const int existing { open(path.c_str(), O_RDWR) };
+    if (existing < 0) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    return existing;
+}
+
+FactorStore::~FactorStore() {
+    if (mappedFile) munmap(mappedFile, mappedFileSize);
+}
+
+bool FactorStore::find(const uint64_t n, Factorization& factorization) const {
+    const uint64_t mask { slotCount - 1 };
+    for (uint64_t i { hashIndex(n, mask) }, probe { 0 }; probe < maxProbes; i = (i + 1) & mask, ++probe) {
+        CompactFactorization& slot { slots[i] };
+        const uint64_t key { std::atomic_ref(slot.n).load(std::memory_order_acquire) };
+        if (!key) return false;
+        if (key != n) continue;
+        //claimed but still being written by another thread or process, or abandoned by one that exited partway
+        if (!std::atomic_ref(slot.ready).load(std::memory_order_acquire)) return false;
+        //the file is shared with whatever else maps it, so its entries are not trusted
+        return slot.unpack(factorization, true);
+    }
+    return false;
+}
+
+void FactorStore::insert(const uint64_t n, const Factorization& factorization) {
+    CompactFactorization entry;
+    if (!entry.pack(n, factorization)) return;
+
+    const uint64_t mask { slotCount - 1 };
+    for (uint64_t i { hashIndex(n, mask) }, probe { 0 }; probe < maxProbes; i = (i + 1) & mask, ++probe) {
+        CompactFactorization& slot { slots[i] };
+        uint64_t key { 0 };
+        if (std::atomic_ref(slot.n).compare_exchange_strong(key, n, std::memory_order_acq_rel)) {
+            slot.primes = entry.primes;
+            std::atomic_ref(slot.ready).store(1, std::memory_order_release);
+            return;
+        }
+        //already stored, or being stored, by someone else
+        if (key == n) return;
+    }
+}
+
+FactorCache::FactorCache(const uint64_t capacity, FactorStore* store_) :
+    sets(capacity ? std::bit_ceil((capacity + ways - 1) / ways) : 0),
+    entries(sets.size() * ways),
+    store(store_) {}
+
+CacheResult FactorCache::lookup(const uint64_t n, Factorization& factorization) {
+    if (n < 2) return CacheResult::MISS;
+    if (!sets.empty()) {
+        set& candidates { sets[hashIndex(n, sets.size() - 1)] };
+        for (size_t way { 0 }; way < ways; ++way) {
+            if (candidates.keys[way] != n) continue;
+            candidates.referenced |= 1u << way;
+            //packed by this cache, or verified when found in the store, so only needs unpacking
+            if (entries[(&candidates - sets.data()) * ways + way].unpack(factorization)) return CacheResult::MEMORY_HIT;
+        }
+    }
+    if (store && store->find(n, factorization)) {
+        CompactFactorization entry;
+        if (!sets.empty() && entry.pack(n, factorization)) insertInMemory(n, entry);
+        return CacheResult::STORE_HIT;
+    }
+    return CacheResult::MISS;
+}
+
+void FactorCache::insert(const uint64_t n, const Factorization& factorization) {
+    if (n < 2) return;
+    CompactFactorization entry;
+    if (!entry.pack(n, factorization)) return;
+    if (!sets.empty()) insertInMemory(n, entry);
+    if (store) store->insert(n, factorization);
+}
+
+void FactorCache::insertInMemory(const uint64_t n, const CompactFactorization& entry) {
+    const size_t setIndex { hashIndex(n, sets.size() - 1) };
+    set& target { sets[setIndex] };
+    size_t way { 0 };
+    while (way < ways && target.keys[way] && target.keys[way] != n) ++way;
+    //full, so the hand sweeps past recently referenced ways, clearing their bits, to the first that was not
+    if (way == ways) {
+        while (target.referenced & (1u << target.hand)) {
+            target.referenced &= ~(1u << target.hand);
+            target.hand = (target.hand + 1) % ways;
+        }
+        way = target.hand;
+        target.hand = (target.hand + 1) % ways;
+    }
+    target.keys[way] = n;
+    target.referenced &= ~(1u << way);
+    entries[setIndex * ways + way] = entry;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "factorization.hpp"
+
+//where a factorization came from, for inputs factored while a FactorCache is in use
+enum class CacheResult : uint8_t {
+    UNCACHED, MISS, MEMORY_HIT, STORE_HIT
+};
+
+//a factorization in a single cache line, as n and its distinct prime factors below 2^32 in ascending order
+//exponents, and the one prime factor above 2^32 that n may have, are recovered by division when unpacked
+//ready is set once the rest of the entry is written, so that an entry shared through a FactorStore is never read half written
+struct CompactFactorization {
+    uint64_t n;
+    uint32_t ready;
+    std::array<uint32_t, 13> primes;
+
+    //returns false, leaving the entry unusable, if factorization has more distinct primes below 2^32 than fit
+    //(at least 14, so n is at least their product ~1.3 * 10^16, and such n are vanishingly rare)
+    bool pack(const uint64_t n_, const Factorization& factorization);
+    //returns false if the entry does not describe a factorization of n into ascending factors
+    //verifyPrimes also rejects any factor that is not prime, at the cost of a miller-rabin test per factor,
+    //for entries this process did not pack itself, e.g. from a store file written by something else
+    bool unpack(Factorization& factorization, const bool verifyPrimes = false) const;
+};
+static_assert(sizeof(CompactFactorization) == 64);
+
+//persistent open addressing table of factorizations, memory mapped from a file and shared by every process that maps it
+//entries are claimed with a compare and swap on n and are never evicted, so lookups and insertions need no locks, even between processes
+//once the table is nearly full, insertions that find no free slot within maxProbes are dropped
+class FactorStore {
+public:
+    //maps the table at path, creating it with slotCount slots if the file is empty or missing
+    //an existing table keeps the slot count it was created with
+    //throws std::runtime_error if the file cannot be opened or mapped, or holds something other than a table
+    FactorStore(const std::string& path, const uint64_t slotCount = defaultSlotCount);
+    ~FactorStore();
+
+    FactorStore(const FactorStore&) = delete;
+    FactorStore& operator=(const FactorStore&) = delete;
+
+    bool find(const uint64_t n, Factorization& factorization) const;
+    void insert(const uint64_t n, const Factorization& factorization);
+
+    uint64_t getSlotCount(void) const { return slotCount; }
+
+    //64MiB once every slot has been written to; the file is sparse until then
+    static constexpr uint64_t defaultSlotCount = 1u << 20;
+    static constexpr size_t maxProbes = 16;
+
+private:
+    struct header {
+        char magic[8];
+        uint64_t slotCount;
+        char reserved[48];
+    };
+    static constexpr char storeMagic[8] = "FCTSTR1";
+
+    //creates a table at path, replacing it if it is an empty file, and returns a descriptor open on it for reading and writing
+    //if another process creates one at path first, the descriptor is for that table instead
+    static int createTable(const std::string& path, const uint64_t slotCount_, const bool replaceEmpty);
+
+    CompactFactorization* slots = nullptr;
+    uint64_t slotCount = 0;
+    void* mappedFile = nullptr;
+    size_t mappedFileSize = 0;
+};
+
+//bounded in memory cache of factorizations for a single thread, in front of an optional shared FactorStore
+//set associative, with sets of ways entries each evicted by CLOCK, so that a lookup touches one set's keys and a single entry
+class FactorCache {
+public:
+    //capacity is rounded up to a whole number of sets; 0 keeps nothing in memory, consulting only store
+    FactorCache(const uint64_t capacity, FactorStore* store_ = nullptr);
+
+    //fills factorization and returns where it was found if n is cached, otherwise returns CacheResult::MISS
+    //entries found in the store are also kept in memory
+    CacheResult lookup(const uint64_t n, Factorization& factorization);
+    //caches the factorization of n after a miss, in memory and in the store
+    void insert(const uint64_t n, const Factorization& factorization);
+
+    static constexpr size_t ways = 8;
+
+private:
+    struct set {
+        //0 marks an empty way, as 0 and 1 are never cached
+        std::array<uint64_t, ways> keys {};
+        //CLOCK reference bit of each way
+        uint8_t referenced = 0;
+        uint8_t hand = 0;
+    };
+
+    void insertInMemory(const uint64_t n, const CompactFactorization& entry);
+
+    std::vector<set> sets;
+    //ways entries per set, in set order
+    std::vector<CompactFactorization> entries;
+    FactorStore* store;
+};
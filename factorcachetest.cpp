@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "factorcache.hpp"
+#include "primes.hpp"
+#include "splitmix64.hpp"
+#include "workloads.hpp"
+
+//checks that CompactFactorization round trips every factorization it accepts, and that a FactorStore reopened from its file
+//finds what an earlier instance inserted, as another process sharing the file would
+//exits nonzero if any check fails
+static unsigned failures { 0 };
+
+static void check(const bool passed, const std::string& what) {
+    if (passed) return;
+    std::println(stderr, "failed: {}", what);
+    ++failures;
+}
+
+static void checkRoundTrip(const uint64_t n, const bool expectPacked) {
+    const Factorization expected { primes::primeFactorization(n, primes::Engine::TIERED) };
+    CompactFactorization entry;
+    const bool packed { entry.pack(n, expected) };
+    check(packed == expectPacked, std::format("{} is{} packed", n, packed ? "" : " not"));
+    if (!packed) return;
+    Factorization found;
+    check(entry.unpack(found) && found.asString() == expected.asString(), std::format("{} unpacks as {}", n, found.asString()));
+    check(entry.unpack(found, true), std::format("{} unpacks with its primes verified", n));
+}
+
+int main(void) {
+    //13 distinct primes below 2^32 fit, and 14 or more do not
+    checkRoundTrip(304250263527210ull, true);
+    checkRoundTrip(2ull * 304250263527210ull, true);
+    checkRoundTrip(13082761331670030ull, false);
+    checkRoundTrip(614889782588491410ull, false);
+    //a factor above 2^32 is left over and recovered by division
+    checkRoundTrip(4294967311ull, true);
+    checkRoundTrip(3ull * 5 * 4294967311ull, true);
+    checkRoundTrip(18446744073709551557ull, true);
+    checkRoundTrip((1ull << 20) * 4294967311ull, true);
+
+    SplitMix64 gen(0xbb67ae8584caa73b);
+    std::vector<uint64_t> inputs;
+    for (const Workload workload : workloads) for (const uint64_t n : generateWorkload(workload, 64, 256, gen())) inputs.push_back(n);
+    for (const uint64_t n : inputs) checkRoundTrip(n, true);
+
+    //entries that are not a factorization of n are rejected, and, when verifying primes as for entries from a store,
+    //so are ones with a composite factor, including a composite leftover above 2^32
+    CompactFactorization forged {};
+    forged.n = 65537ull * 65539 * 65543;
+    forged.ready = 1;
+    Factorization unpacked;
+    check(!forged.unpack(unpacked, true), "a composite leftover is rejected");
+    forged.n = 3 * 5 * 7;
+    forged.primes[0] = 3;
+    forged.primes[1] = 5;
+    check(!forged.unpack(unpacked), "a leftover below 2^32 is rejected");
+    forged.n = 6;
+    forged.primes = {};
+    forged.primes[0] = 6;
+    check(!forged.unpack(unpacked, true), "a composite factor is rejected");
+    forged.n = 15;
+    forged.primes[0] = 5;
+    forged.primes[1] = 3;
+    check(!forged.unpack(unpacked), "factors out of order are rejected");
+    forged.primes[1] = 5;
+    check(!forged.unpack(unpacked), "a repeated factor is rejected");
+
+    char directory[] { "/tmp/factorcachetestXXXXXX" };
+    if (!mkdtemp(directory)) {
+        std::println(stderr, "cannot create a temporary directory");
+        return 1;
+    }
+    const std::string path { std::string(directory) + "/factorcache.bin" };
+    {
+        FactorStore store(path, 1u << 12);
+        for (const uint64_t n : inputs) store.insert(n, primes::primeFactorization(n, primes::Engine::TIERED));
+    }
+    {
+        //the slot count requested here is ignored in favour of the one the table was created with
+        const FactorStore store(path, 1u << 16);
+        check(store.getSlotCount() == 1u << 12, "a reopened store keeps its slot count");
+        size_t found { 0 };
+        for (const uint64_t n : inputs) {
+            Factorization factorization;
+            if (!store.find(n, factorization)) continue;
+            ++found;
+            check(factorization.asString() == primes::primeFactorization(n, primes::Engine::TIERED).asString(), std::format("{} is found as {}", n, factorization.asString()));
+        }
+        //only insertions that found no free slot within maxProbes are dropped, which a table this empty makes rare
+        check(found * 10 >= inputs.size() * 9, std::format("a reopened store finds {} of {} inputs", found, inputs.size()));
+    }
+
+    //an empty file is replaced by a new table, but anything else that is not a table is refused
+    const std::string otherPath { std::string(directory) + "/other.bin" };
+    std::fclose(std::fopen(otherPath.c_str(), "w"));
+    check(FactorStore(otherPath, 64).getSlotCount() == 64, "an empty file becomes a new table");
+    FILE* other { std::fopen(otherPath.c_str(), "w") };
+    std::fputs("not a factorization cache", other);
+    std::fclose(other);
+    bool refused { false };
+    try { FactorStore store(otherPath); }
+    catch (const std::runtime_error&) { refused = true; }
+    check(refused, "a file holding something else is refused");
+
+    std::filesystem::remove_all(directory);
+    std::println("{} inputs round tripped, {} failures", inputs.size(), failures);
+    return failures != 0;
+}
@@ -0,0 +1,50 @@
+#include "factorcounter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+//position in denseCounts of each odd prime below denseBound, indexed by p / 2
+//composites are left at 0, which is 2's position; 2 itself is handled separately as it would share 3's index
+static constexpr std::array<uint16_t, FactorCounter::denseBound / 2> densePrimeIndex { []{
+    std::array<bool, FactorCounter::denseBound> isComposite {};
+    std::array<uint16_t, FactorCounter::denseBound / 2> indices {};
+    size_t i { 1 };
+    for (uint64_t p { 3 }; p < FactorCounter::denseBound; p += 2) {
+        if (isComposite[p]) continue;
+        indices[p / 2] = i++;
+        for (uint64_t multiple { p * p }; multiple < FactorCounter::denseBound; multiple += 2 * p) isComposite[multiple] = true;
+    }
+    //throwing is not a constant expression, so a wrong count fails compilation
+    if (i != FactorCounter::densePrimeCount) throw std::logic_error("densePrimeCount is wrong");
+    return indices;
+}() };
+
+FactorCounter::FactorCounter() : heavyHitters(heavyHitterCapacity) {}
+
+void FactorCounter::add(const uint64_t base, const uint64_t exp) {
+    if (base == 2) denseCounts[0] += exp;
+    else if (base < denseBound) denseCounts[densePrimeIndex[base / 2]] += exp;
+    else heavyHitters.add(base, exp);
+}
+
+void FactorCounter::merge(const FactorCounter& other) {
+    for (size_t i { 0 }; i < densePrimeCount; ++i) denseCounts[i] += other.denseCounts[i];
+    heavyHitters.merge(other.heavyHitters);
+}
+
+std::vector<FactorCounter::FactorCount> FactorCounter::mostCommon(const size_t count) const {
+    std::vector<FactorCount> candidates;
+    if (denseCounts[0]) candidates.push_back({ 2, denseCounts[0], true });
+    for (uint64_t p { 3 }; p < denseBound; p += 2) {
+        if (!densePrimeIndex[p / 2]) continue;
+        if (const uint64_t pCount { denseCounts[densePrimeIndex[p / 2]] }) candidates.push_back({ p, pCount, true });
+    }
+    for (const SpaceSavingCounter::Entry& entry : heavyHitters.viewEntries()) 
+        if (entry.count > entry.error) candidates.push_back({ entry.key, entry.count - entry.error, !entry.error });
+
+    const auto moreCommon = [](const FactorCount& a, const FactorCount& b){ return a.count > b.count || (a.count == b.count && a.base < b.base); };
+    const size_t kept { std::min(count, candidates.size()) };
+    std::partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(), moreCommon);
+    candidates.resize(kept);
+    return candidates;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "spacesaving.hpp"
+
+//counts every prime factor found, as if the product of all inputs was factorized, in bounded memory
+//primes below denseBound are counted exactly in an array indexed by prime; rarer larger primes go to a SpaceSavingCounter
+class FactorCounter {
+public:
+    struct FactorCount {
+        uint64_t base, count;
+        //false if count is only a lower bound on how often base was seen
+        bool exact;
+    };
+
+    FactorCounter();
+
+    void add(const uint64_t base, const uint64_t exp);
+    void merge(const FactorCounter& other);
+
+    //up to count of the most common factors, most common first, ties in ascending order of base
+    //large primes are ranked by the count they are guaranteed to have reached, so one only appears once it is certain to be that common
+    std::vector<FactorCount> mostCommon(const size_t count) const;
+
+    static constexpr uint64_t denseBound = 1u << 16;
+    //2 and the odd primes below denseBound
+    static constexpr size_t densePrimeCount = 6542;
+    //enough to hold any large prime accounting for more than 1/1024 of large prime factors
+    static constexpr size_t heavyHitterCapacity = 1024;
+
+private:
+    std::array<uint64_t, densePrimeCount> denseCounts {};
+    SpaceSavingCounter heavyHitters;
+};
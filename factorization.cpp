@@ -1,40 +1,57 @@
 #include "factorization.hpp"
+#include "utils.hpp"
 
-Factorization::Factorization() {
-    //covers the vast majority of factorizations, including the slow case where the 2nd largest factor is very large
-    //in worst case, requires no more than 1 reallocation (1.5x scaling assumed; still also applies to 2x)
-    //note that lengths above 11 are very rare also
-    factors.reserve(11);
-}
+#include <algorithm>
+#include <charconv>
 
-void Factorization::addNewFactor(const base_t base, const exp_t exp) {
+template<class Base>
+void BasicFactorization<Base>::addNewFactor(const base_t base, const exp_t exp) {
     factorCount += exp; 
-    factors.emplace_back(base, exp);
+    bases[uniqueFactorCount] = base;
+    exps[uniqueFactorCount++] = exp;
+}
+
+template<class Base>
+std::string BasicFactorization<Base>::asString() const {
+    char text[maxFormattedLength];
+    return std::string(text, formatTo(text));
 }
 
-std::string Factorization::asString() const {
-    if (factors.empty()) 
-        return "= DNE";
-    else {
-        std::string out("="); 
-        for (const auto& fac : factors) {
-            out += std::format(" {}", fac.base);
-            //caret notation is redundant when exp <= 1
-            //uint_fast8_t is often defined as an unsigned char, hence the need for a cast
-            if (fac.exp > 1) out += std::format("^{}", static_cast<unsigned short>(fac.exp));
+template<class Base>
+char* BasicFactorization<Base>::formatTo(char* out) const {
+    if (!uniqueFactorCount) 
+        return std::copy_n("= DNE", 5, out);
+    *out++ = '=';
+    for (const auto& fac : viewFactors()) {
+        *out++ = ' ';
+        //std::to_chars has no portable support for 128 bit integers
+        if constexpr (sizeof(Base) > sizeof(uint64_t)) out = toDecimalChars(out, fac.base);
+        else out = std::to_chars(out, out + 20, fac.base).ptr;
+        //caret notation is redundant when exp <= 1
+        //uint_fast8_t is often defined as an unsigned char, hence the need for a cast
+        if (fac.exp > 1) {
+            *out++ = '^';
+            out = std::to_chars(out, out + 3, static_cast<unsigned short>(fac.exp)).ptr;
         }
-        return out;
     }
+    return out;
 }
 
-const uint_fast8_t Factorization::getFactorCount() const {
+template<class Base>
+const uint_fast8_t BasicFactorization<Base>::getFactorCount() const {
     return factorCount;
 }
 
-const uint_fast8_t Factorization::getUniqueFactorCount() const {
-    return factors.size();
+template<class Base>
+const uint_fast8_t BasicFactorization<Base>::getUniqueFactorCount() const {
+    return uniqueFactorCount;
 }
 
-const Factorization::container_t& Factorization::viewFactors(void) const {
-    return factors;
+template<class Base>
+typename BasicFactorization<Base>::FactorView BasicFactorization<Base>::viewFactors(void) const {
+    return *this;
 }
+
+template class BasicFactorization<uint32_t>;
+template class BasicFactorization<uint64_t>;
+template class BasicFactorization<unsigned __int128>;
@@ -1,44 +1,108 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <format>
 #include <string>
-#include <vector>
 #include <span>
 
-class Factorization {
+//Base is the unsigned integer type of the number factored; uint32_t, uint64_t and unsigned __int128 are supported
+//factors are stored inline, so constructing, copying or moving a factorization never allocates
+template<class Base>
+class BasicFactorization {
 public:
-    using base_t = uint64_t;
+    using base_t = Base;
     using exp_t = uint_fast8_t;
 
-private:    
     //base exponent pair
     struct factor {
-        factor(base_t base_, exp_t exp_) : base(base_), exp(exp_) {}
-
         base_t base;
         //64 bit numbers cannot have factors with exp greater than floor(log2(2^64 - 1)) == 63
         //therefore this is guranteed to be sufficient theoretically through a 256 bit num
         exp_t exp; 
     };
 
-public:
-    Factorization();
-    using container_t = std::vector<factor>;
+    //the most distinct primes any base_t can have, i.e. the length of the longest primorial that fits
+    //9 for 32 bits, 15 for 64 bits and 26 for 128 bits
+    static constexpr size_t maxUniqueFactors = [] {
+        size_t count { 0 };
+        base_t primorial { 1 };
+        for (base_t p { 2 }; ; ++p) {
+            bool isPrime { true };
+            for (base_t d { 2 }; d * d <= p; ++d) if (p % d == 0) isPrime = false;
+            if (!isPrime) continue;
+            if (primorial > static_cast<base_t>(~base_t(0)) / p) return count;
+            primorial *= p;
+            ++count;
+        }
+    }();
+
+    //read only range over the factors in ascending order of base, yielding factor values
+    class FactorView {
+    public:
+        class iterator {
+        public:
+            using value_type = factor;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            iterator(const BasicFactorization* owner_, size_t i_) : owner(owner_), i(i_) {}
+            factor operator*() const { return { owner->bases[i], owner->exps[i] }; }
+            iterator& operator++() { ++i; return *this; }
+            iterator operator++(int) { iterator old { *this }; ++i; return old; }
+            bool operator==(const iterator& other) const { return i == other.i; }
+
+        private:
+            const BasicFactorization* owner = nullptr;
+            size_t i = 0;
+        };
+
+        FactorView(const BasicFactorization& owner_) : owner(&owner_) {}
+        iterator begin() const { return { owner, 0 }; }
+        iterator end() const { return { owner, owner->uniqueFactorCount }; }
+        size_t size() const { return owner->uniqueFactorCount; }
+        bool empty() const { return !owner->uniqueFactorCount; }
+        factor operator[](const size_t i) const { return { owner->bases[i], owner->exps[i] }; }
+
+    private:
+        const BasicFactorization* owner;
+    };
+
+    BasicFactorization() = default;
+    //converts between widths, e.g. to return a factorization calculated with narrower arithmetic
+    //precondition: every base fits in Base
+    template<class OtherBase>
+    explicit BasicFactorization(const BasicFactorization<OtherBase>& other) {
+        for (const auto& [base, exp] : other.viewFactors()) addNewFactor(static_cast<base_t>(base), exp);
+    }
     
+    //precondition: base is a prime not already added
     void addNewFactor(const base_t base, const exp_t exp);
     
     //takes a prime factorization as returned by primeFactorization() and converts it to a string
     std::string asString(void) const; 
+    //writes the same text as asString starting at out, returning its end
+    //precondition: at least maxFormattedLength characters are available
+    char* formatTo(char* out) const;
+    //a space, up to 39 digits, a caret and up to 3 exponent digits per factor, after the leading "="
+    static constexpr size_t maxFormattedLength = 8 + maxUniqueFactors * 44;
     
     const uint_fast8_t getFactorCount(void) const;
     const uint_fast8_t getUniqueFactorCount(void) const;
 
-    const container_t& viewFactors(void) const;
+    FactorView viewFactors(void) const;
 
 private:
     //stores the total number of prime factors as sum(exp)
     uint_fast8_t factorCount = 0;
+    uint_fast8_t uniqueFactorCount = 0;
 
-    container_t factors;
+    //kept as separate arrays rather than an array of factors, which would pad every exponent to the width of a base
+    std::array<base_t, maxUniqueFactors> bases {};
+    std::array<exp_t, maxUniqueFactors> exps {};
 };
+
+using Factorization32 = BasicFactorization<uint32_t>;
+using Factorization = BasicFactorization<uint64_t>;
+using Factorization128 = BasicFactorization<unsigned __int128>;
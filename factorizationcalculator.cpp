@@ -1,11 +1,121 @@
 #include "factorizationcalculator.hpp"
 
 FactorizationCalculator::FactorizationCalculator() {
+    //escape sequences are only useful to a terminal
+    setPlainTextOutput(!isatty(STDOUT_FILENO));
     //TODO add option for saving and loading settings from file
     promptForMode();
 
     promptForSettings();
-    stats.emplace(inputCount);
+    applySettings(inputCount);
+}
+
+//parses a whole argument as an unsigned integer, naming the option it belongs to if it is not one
+template<class T>
+static T parseArgument(const std::string_view option, const std::string_view text) {
+    T value;
+    const auto [end, error] { std::from_chars(text.data(), text.data() + text.size(), value) };
+    if (error != std::errc() || end != text.data() + text.size()) 
+        throw std::invalid_argument(std::format("{} expects a nonnegative integer, not \"{}\"", option, text));
+    return value;
+}
+
+FactorizationCalculator::FactorizationCalculator(const std::vector<std::string_view>& args) : 
+    mode(InputMode::BATCH), 
+    engine(primes::Engine::TIERED), 
+    //discovered while parsing
+    inputCount(0), 
+    minN(0), maxN(0), //indicates unset
+    reportIndividualFactorizations(false), 
+    sieveRange(false), 
+    narrowInputs(false), 
+    threadCount(0), 
+    primeTableBound(primes::defaultPrimeTableBound), 
+    cachePrimeTable(false), 
+    timingMode(TimingMode::EVERY_INPUT), 
+    timingInterval(1), 
+    collectHardwareCounters(false), 
+    factorCacheCapacity(0), 
+    telemetryPort(0) {
+    //escape sequences are only useful to a terminal
+    setPlainTextOutput(!isatty(STDOUT_FILENO));
+    std::string inputPath;
+    for (size_t i { 0 }; i < args.size(); ++i) {
+        const std::string_view option { args[i] };
+        const auto value = [&] {
+            if (++i == args.size()) throw std::invalid_argument(std::format("{} expects a value", option));
+            return args[i];
+        };
+
+        if (option == "--batch") inputPath = value();
+        else if (option == "--engine") {
+            const std::string_view name { value() };
+            if (name == "trial") engine = primes::Engine::TRIAL_DIVISION;
+            else if (name == "rho") engine = primes::Engine::POLLARD_RHO;
+            else if (name == "tiered") engine = primes::Engine::TIERED;
+            else throw std::invalid_argument(std::format("unknown engine \"{}\"", name));
+        }
+        else if (option == "--threads") threadCount = parseArgument<unsigned>(option, value());
+        else if (option == "--table-bound") primeTableBound = std::min(parseArgument<uint64_t>(option, value()), PrimeTable::maxBound);
+        else if (option == "--cache-table") cachePrimeTable = true;
+        else if (option == "--report") reportIndividualFactorizations = true;
+        else if (option == "--plain") setPlainTextOutput(true);
+        else if (option == "--counters") collectHardwareCounters = true;
+        else if (option == "--cache") factorCacheCapacity = parseArgument<uint64_t>(option, value());
+        else if (option == "--cache-file") factorStorePath = value();
+        else if (option == "--telemetry") telemetryPort = parseArgument<uint16_t>(option, value());
+        else if (option == "--telemetry-socket") telemetrySocketPath = value();
+        else if (option == "--sample-timing" || option == "--block-timing" || option == "--interleave") {
+            timingMode = option == "--sample-timing" ? TimingMode::SAMPLED : option == "--block-timing" ? TimingMode::BLOCK : TimingMode::INTERLEAVED;
+            timingInterval = parseArgument<uint64_t>(option, value());
+            if (!timingInterval || (timingMode != TimingMode::SAMPLED && timingInterval > maxTimingBlock)) 
+                throw std::invalid_argument(std::format("{} expects a value from 1 to {}", option, timingMode != TimingMode::SAMPLED ? maxTimingBlock : std::numeric_limits<uint64_t>::max()));
+        }
+        else throw std::invalid_argument(std::format("unknown argument \"{}\"", option));
+    }
+    if (inputPath.empty()) throw std::invalid_argument("--batch is required");
+    if (timingMode == TimingMode::INTERLEAVED && engine != primes::Engine::TIERED) throw std::invalid_argument("--interleave requires the tiered engine");
+    if (!threadCount) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    batchInput.emplace(inputPath);
+    //the true count is unknown until the input is parsed, and only sizes the statistics' record lists
+    applySettings(batchInput->getMaxCount() ? batchInput->getMaxCount() : std::numeric_limits<uint64_t>::max());
+}
+
+void FactorizationCalculator::applySettings(const uint64_t expectedInputCount_) {
+    expectedInputCount = expectedInputCount_;
+    stats.emplace(expectedInputCount);
+    pool.emplace(threadCount);
+
+    //sieved ahead of time so that it is not counted towards the first factorization's calcTime
+    primes::loadPrimeTable(primeTableBound, cachePrimeTable ? primeTableCachePath : "");
+    primes::setTierCrossovers(tierCrossovers);
+    //likewise, and before any input is timed so that every measurement is converted at the same rate
+    TscClock::calibrate();
+    if (collectHardwareCounters) {
+        const std::string unavailableReason { PerfCounters::probe() };
+        if (!unavailableReason.empty()) {
+            std::println(stderr, "Hardware counters unavailable: {}. Continuing without them.", unavailableReason);
+            collectHardwareCounters = false;
+        }
+    }
+
+    factorCaches.clear();
+    factorStore.reset();
+    if (!factorStorePath.empty()) {
+        try { factorStore.emplace(factorStorePath); }
+        catch (const std::runtime_error& error) { std::println(stderr, "Factorization cache file unavailable: {}. Continuing without it.", error.what()); }
+    }
+    if (factorCacheCapacity || factorStore) 
+        for (unsigned i { 0 }; i < pool->getThreadCount(); ++i) factorCaches.emplace_back(factorCacheCapacity, factorStore ? &*factorStore : nullptr);
+
+    telemetry.reset();
+    if (telemetryPort || !telemetrySocketPath.empty()) {
+        //batch mode's total is unknown until its input has been parsed
+        try { telemetry.emplace(telemetryPort, telemetrySocketPath, pool->getThreadCount(), mode == InputMode::BATCH ? 0 : inputCount); }
+        catch (const std::runtime_error& error) { std::println(stderr, "Telemetry unavailable: {}. Continuing without it.", error.what()); }
+        if (telemetry) std::println(stderr, "Serving telemetry at {}", telemetry->describeEndpoint());
+    }
 }
 
 void FactorizationCalculator::run(void) {
@@ -21,9 +131,16 @@ void FactorizationCalculator::run(void) {
         randomInputTest();
         break;
     case InputMode::RANGE:
-        rangeBasedInputTest();
+        if (sieveRange) sievedRangeInputTest();
+        else rangeBasedInputTest();
+        break;
+    case InputMode::BATCH:
+        batchInputTest();
         break;
     }
+    //merged in worker order, independent of the order in which workers finished
+    for (const StatSet& shard : shards) stats->mergeShard(shard);
+    shards.clear();
 
     std::chrono::duration<long double> executionTime { std::chrono::steady_clock::now() - start };
 
@@ -34,8 +151,12 @@ void FactorizationCalculator::run(void) {
     std::print("{} factorizations{} calculated in {}.\n", inputCount, maxN ? std::format(" of numbers{} <= {}", (minN ? std::format(" >= {} and", minN) : ""), maxN) : "", executionTime);
     
     stats->printout();
+    printTimingReport();
+    if (mode != InputMode::MANUAL) printThreadReport();
     FILE* resultsFile = std::fopen("results.ansi", "w");
     stats->printout(resultsFile);
+    printTimingReport(resultsFile);
+    if (mode != InputMode::MANUAL) printThreadReport(resultsFile);
     fclose(resultsFile);
 }
 
@@ -47,13 +168,59 @@ void FactorizationCalculator::promptForMode(void) {
 void FactorizationCalculator::promptForSettings(void) {
     //prompts user for mode relevant settings
     if (mode == InputMode::MANUAL || mode == InputMode::RANDOM)
-        inputCount = promptIndividualSetting<uint64_t>("Count: ", [&](uint64_t input){ return input < stats->getMaxValidInputCount(); });
-    if (mode == InputMode::RANGE) 
+        inputCount = promptIndividualSetting<uint64_t>("Count: ", [&](uint64_t input){ return input < StatSet::getMaxValidInputCount(); });
+    if (mode == InputMode::RANGE) {
         minN = promptIndividualSetting<uint64_t>("Lower Bound: "); //while applicable to random, generally found to be less useful than annoying
+        sieveRange = 'y' == std::tolower(promptIndividualSetting<char>("Sieve Range in Blocks? (y/n): ", [](char input){ return tolower(input) == 'y' || tolower(input) == 'n'; }));
+    }
+    else sieveRange = false;
     if (mode == InputMode::RANDOM || mode == InputMode::RANGE) {
         maxN = promptIndividualSetting<uint64_t>("Upper Bound (0 for max): ");
         reportIndividualFactorizations = 'y' == std::tolower(promptIndividualSetting<char>("Report Individual Factorizations? (y/n): ", [](char input){ return tolower(input) == 'y' || tolower(input) == 'n'; }));
         if (!maxN) maxN = std::numeric_limits<uint64_t>::max();
+        threadCount = promptIndividualSetting<unsigned>("Thread Count (0 for all): ");
+        if (!threadCount) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        telemetryPort = promptIndividualSetting<unsigned>("Telemetry Port (0 for none): ", [](unsigned input){ return input <= std::numeric_limits<uint16_t>::max(); });
+    }
+    else telemetryPort = 0;
+
+    //converts user input int to a primes::Engine
+    engine = static_cast<primes::Engine>(promptIndividualSetting<int>("Factorization Engine:\n[1]Trial Division\n[2]Miller-Rabin + Pollard-Brent Rho\n[3]Size Tiered (Trial Division/Hart OLF + Lehman/SQUFOF/Rho)\n", [](int input){ return input > 0 && input <= engineCount; }) - 1);
+    if (engine == primes::Engine::TRIAL_DIVISION) {
+        primeTableBound = promptIndividualSetting<uint64_t>("Prime Table Bound (0 for 2^32): ", [](uint64_t input){ return input <= PrimeTable::maxBound; });
+        if (!primeTableBound) primeTableBound = PrimeTable::maxBound;
+        cachePrimeTable = 'y' == std::tolower(promptIndividualSetting<char>("Cache Prime Table to Disk? (y/n): ", [](char input){ return tolower(input) == 'y' || tolower(input) == 'n'; }));
+    }
+    //only the smallest primes are needed by the other engines
+    else {
+        primeTableBound = primes::defaultPrimeTableBound;
+        cachePrimeTable = false;
+    }
+    //sieved ranges are always timed a block at a time, see RangeSieve
+    if ((mode == InputMode::RANDOM || mode == InputMode::RANGE) && !sieveRange) {
+        //only the tiered engine has an interleaved form
+        const int offeredTimingModes { engine == primes::Engine::TIERED ? timingModeCount : timingModeCount - 1 };
+        timingMode = static_cast<TimingMode>(promptIndividualSetting<int>(std::format("Timing:\n[1]Every Input\n[2]Sampled (1 in k Inputs)\n[3]Blocks (Mean of k Inputs)\n{}", 
+            engine == primes::Engine::TIERED ? "[4]Interleaved Blocks (Mean of k Inputs Factored Together)\n" : ""), [&](int input){ return input > 0 && input <= offeredTimingModes; }) - 1);
+        if (timingMode == TimingMode::SAMPLED) 
+            timingInterval = promptIndividualSetting<uint64_t>("k: ", [](uint64_t input){ return input > 0; });
+        else if (timingMode == TimingMode::BLOCK || timingMode == TimingMode::INTERLEAVED) 
+            timingInterval = promptIndividualSetting<uint64_t>(std::format("k (<= {}): ", maxTimingBlock), [](uint64_t input){ return input > 0 && input <= maxTimingBlock; });
+        else timingInterval = 1;
+    }
+    collectHardwareCounters = 'y' == std::tolower(promptIndividualSetting<char>("Collect Hardware Counters? (y/n): ", [](char input){ return tolower(input) == 'y' || tolower(input) == 'n'; }));
+    //sieved ranges never call the engine, so have nothing to cache
+    factorStorePath.clear();
+    if (!sieveRange) {
+        factorCacheCapacity = promptIndividualSetting<uint64_t>("Cached Factorizations per Thread (0 for none): ");
+        if ('y' == std::tolower(promptIndividualSetting<char>(std::format("Share Cache Between Runs in {}? (y/n): ", defaultFactorStorePath), [](char input){ return tolower(input) == 'y' || tolower(input) == 'n'; })))
+            factorStorePath = defaultFactorStorePath;
+    }
+    else factorCacheCapacity = 0;
+    if (engine == primes::Engine::TIERED && 'y' == std::tolower(promptIndividualSetting<char>("Customize Tier Crossovers? (y/n): ", [](char input){ return tolower(input) == 'y' || tolower(input) == 'n'; }))) {
+        tierCrossovers.trialDivisionMaxBits = promptIndividualSetting<unsigned>(std::format("Trial Division Max Bits (<= {}): ", primes::TierCrossovers::maxTrialDivisionBits), [](unsigned input){ return input <= primes::TierCrossovers::maxTrialDivisionBits; });
+        tierCrossovers.oneLineMaxBits = promptIndividualSetting<unsigned>(std::format("Hart OLF + Lehman Max Bits (<= {}): ", primes::TierCrossovers::maxOneLineBits), [](unsigned input){ return input <= primes::TierCrossovers::maxOneLineBits; });
+        tierCrossovers.squfofMaxBits = promptIndividualSetting<unsigned>(std::format("SQUFOF Max Bits (<= {}, Rho beyond): ", primes::TierCrossovers::maxSqufofBits), [](unsigned input){ return input <= primes::TierCrossovers::maxSqufofBits; });
     }
 
     //TODO allow settings to be saved per mode here
@@ -62,75 +229,309 @@ void FactorizationCalculator::promptForSettings(void) {
     if (mode == InputMode::MANUAL) {
         minN = maxN = 0; //indicates unset
         reportIndividualFactorizations = true;
+        threadCount = 1;
+        timingMode = TimingMode::EVERY_INPUT;
+        timingInterval = 1;
     }
     if (mode == InputMode::RANDOM)
         minN = 0;
     if (mode == InputMode::RANGE) 
         inputCount = (maxN - minN) + 1;
+    if (sieveRange) {
+        timingMode = TimingMode::BLOCK;
+        timingInterval = RangeSieve::blockSize;
+    }
+    narrowInputs = maxN <= std::numeric_limits<uint32_t>::max();
+    //the sieve needs primes through sqrt(maxN) to avoid falling back on the engine for large cofactors
+    if (sieveRange) 
+        primeTableBound = std::min(std::max(primeTableBound, primes::isqrt(maxN) + 1), PrimeTable::maxBound);
 }
 
 void FactorizationCalculator::manualInputTest() {
     for (uint64_t i { 1 }; i <= inputCount; ++i) {
-        FactorCalculationInfo infoSet { 0 }; //0 placeholds until user input is received
+        //read as text, as std::cin has no support for 128 bit integers
+        std::optional<unsigned __int128> n;
+        while (!(n = parseUint128(promptIndividualSetting<std::string>(std::format("({}/{}) Num: ", i, inputCount)))))
+            std::println("Not a nonnegative integer below 2^128");
 
-        std::print("({}/{}) Num: ", i, inputCount);
-        std::cin >> infoSet.n;
-        
-        infoSet.calculateAndTime();
-        infoSet.printPostCalcInfo();
+        if (*n <= std::numeric_limits<uint64_t>::max()) {
+            FactorCalculationInfo infoSet { static_cast<uint64_t>(*n) };
+            FactorCache* const cache { getFactorCache(0) };
+            if (cache) infoSet.cacheResult = cache->lookup(infoSet.n, infoSet.factorization);
+            if (!infoSet.isCacheHit()) {
+                if (collectHardwareCounters) infoSet.calculateTimeAndCount(engine);
+                else infoSet.calculateAndTime(engine);
+                if (cache) cache->insert(infoSet.n, infoSet.factorization);
+            }
+            infoSet.printPostCalcInfo();
 
-        stats->handleNewFactorizationData(std::move(infoSet));
+            stats->handleNewFactorizationData(std::move(infoSet));
+        }
+        //stats are gathered on 64 bit factorizations only
+        else {
+            FactorCalculationInfo128 infoSet { *n };
+            infoSet.calculateAndTime(engine);
+            infoSet.printPostCalcInfo();
+            std::println("(beyond 64 bits; not included in statistics)\n");
+        }
     }
 }
 
 void FactorizationCalculator::randomInputTest() {
-    std::mt19937 gen(std::random_device{}());
+    std::random_device seedSource;
+    SplitMix64 seeder((static_cast<uint64_t>(seedSource()) << 32) | seedSource());
+    //fixed seed, so that every run factors the same inputs
     #ifdef DERANDOMIZE 
-    gen.seed(0); 
-    asm(int 3);
+    seeder = SplitMix64(0); 
     #endif
-    std::uniform_int_distribution<uint64_t> flatDistr(0, maxN);
 
-    for (uint64_t i { 1 }; i <= inputCount; ++i) {
-        FactorCalculationInfo infoSet { flatDistr(gen) };
+    processInParallel(defaultChunkSize, inputCount, [&](const unsigned worker, StatSet& shard, const uint64_t firstIndex, const uint64_t lastIndex) {
+        //each chunk draws from its own stream, so the inputs generated do not depend on which thread handles which chunk
+        SplitMix64 gen { seeder.split(firstIndex / defaultChunkSize) };
+        std::uniform_int_distribution<uint64_t> flatDistr(0, maxN);
+        const auto inputAt = [&](const uint64_t i){ return flatDistr(gen); };
+
+        if (narrowInputs) factorInputs<uint32_t>(shard, getFactorCache(worker), firstIndex, lastIndex, 0, inputCount, inputAt);
+        else factorInputs<uint64_t>(shard, getFactorCache(worker), firstIndex, lastIndex, 0, inputCount, inputAt);
+    });
+}
 
-        //displays the number before calculation begins to give user info about why the program may be taking longer on a factorization
-        //e.g. if a large coprime with factors of similar but inequal value is generated as input
-        if (reportIndividualFactorizations) 
-            std::println("({}/{}): {}", i, inputCount, infoSet.n);
-        else if (yieldsNewIntegerPercentage(i, inputCount)) 
-            //ANSI line clear refreshes completion %  
-            std::println("\033[A\33[2K\r{}%", 100 * i / inputCount);
+void FactorizationCalculator::rangeBasedInputTest() {
+    processInParallel(defaultChunkSize, inputCount, [&](const unsigned worker, StatSet& shard, const uint64_t firstIndex, const uint64_t lastIndex) {
+        const auto inputAt = [&](const uint64_t i){ return (i - 1) + minN; };
+
+        if (narrowInputs) factorInputs<uint32_t>(shard, getFactorCache(worker), firstIndex, lastIndex, 0, inputCount, inputAt);
+        else factorInputs<uint64_t>(shard, getFactorCache(worker), firstIndex, lastIndex, 0, inputCount, inputAt);
+    });
+}
 
-        infoSet.calculateAndTime();
+void FactorizationCalculator::sievedRangeInputTest() {
+    //each worker reuses its own sieve's buffers
+    std::vector<RangeSieve> sieves(pool->getThreadCount(), RangeSieve(engine));
 
-        if (reportIndividualFactorizations) infoSet.printPostCalcInfo();
+    processInParallel(RangeSieve::blockSize, inputCount, [&](const unsigned worker, StatSet& shard, const uint64_t firstIndex, const uint64_t lastIndex) {
+        uint64_t i { firstIndex };
+        for (const FactorCalculationInfo& infoSet : sieves[worker].factorBlock((firstIndex - 1) + minN, (lastIndex - firstIndex) + 1, collectHardwareCounters)) {
+            if (reportIndividualFactorizations) ReportWriter::forThisThread().report(infoSet, i, inputCount);
 
-        stats->handleNewFactorizationData(infoSet);
+            shard.handleNewFactorizationData(infoSet);
+            ++i;
+        }
+    });
+}
+
+void FactorizationCalculator::batchInputTest() {
+    std::vector<uint64_t> batch, nextBatch;
+    batch.reserve(batchSize);
+    nextBatch.reserve(batchSize);
+    batchInput->nextBatch(batch, batchSize);
+
+    while (!batch.empty()) {
+        //parses the next batch on its own thread while the pool factors this one
+        std::jthread parser([&]{ batchInput->nextBatch(nextBatch, batchSize); });
+        const uint64_t batchStart { completedInputs };
+        processInParallel(defaultChunkSize, batch.size(), [&](const unsigned worker, StatSet& shard, const uint64_t firstIndex, const uint64_t lastIndex) {
+            factorInputs<uint64_t>(shard, getFactorCache(worker), firstIndex, lastIndex, batchStart, 0, [&](const uint64_t i){ return batch[i - 1]; });
+        });
+        parser.join();
+        std::swap(batch, nextBatch);
     }
+
+    inputCount = completedInputs;
+    if (telemetry) telemetry->setTotal(inputCount);
+    if (batchInput->getInvalidTokenCount()) 
+        std::println(stderr, "Skipped {} tokens that were not numbers below 2^64", batchInput->getInvalidTokenCount());
 }
 
-void FactorizationCalculator::rangeBasedInputTest() {
-    for (uint64_t i { 1 }; i <= inputCount; ++i) {
-        FactorCalculationInfo infoSet { (i - 1) + minN };
+template<class Width, class InputSource>
+void FactorizationCalculator::factorInputs(StatSet& shard, FactorCache* cache, const uint64_t firstIndex, const uint64_t lastIndex, const uint64_t reportOffset, const uint64_t reportTotal, const InputSource& inputAt) {
+    const auto record = [&](const FactorCalculationInfo& infoSet, const uint64_t i) {
+        //buffers the individual factorization and respective calculation time
+        if (reportIndividualFactorizations) ReportWriter::forThisThread().report(infoSet, reportOffset + i, reportTotal);
+        shard.handleNewFactorizationData(infoSet);
+    };
+
+    const auto measure = [&](FactorCalculationInfo& infoSet) {
+        if (collectHardwareCounters) infoSet.calculateTimeAndCount<Width>(engine);
+        else infoSet.calculateAndTime<Width>(engine);
+    };
+
+    //hits are recorded untimed, and only misses are factored and then cached
+    const auto lookUp = [&](FactorCalculationInfo& infoSet) {
+        if (!cache) return false;
+        infoSet.cacheResult = cache->lookup(infoSet.n, infoSet.factorization);
+        return infoSet.isCacheHit();
+    };
+    const auto store = [&](const FactorCalculationInfo& infoSet) {
+        if (cache) cache->insert(infoSet.n, infoSet.factorization);
+    };
+
+    switch (timingMode) {
+    case TimingMode::EVERY_INPUT:
+        for (uint64_t i { firstIndex }; i <= lastIndex; ++i) {
+            FactorCalculationInfo infoSet { inputAt(i) };
+            if (!lookUp(infoSet)) {
+                measure(infoSet);
+                store(infoSet);
+            }
+            record(infoSet, i);
+        }
+        break;
+    case TimingMode::SAMPLED:
+        //inputs 1, 1 + timingInterval, 1 + 2 * timingInterval, etc. are timed, regardless of how inputs are split into chunks
+        //a sampled input found in the cache goes untimed rather than passing its turn on
+        for (uint64_t i { firstIndex }, untilTimed { (timingInterval - (firstIndex - 1) % timingInterval) % timingInterval }; i <= lastIndex; ++i) {
+            FactorCalculationInfo infoSet { inputAt(i) };
+            const bool timed { !untilTimed };
+            untilTimed = timed ? timingInterval - 1 : untilTimed - 1;
+            if (!lookUp(infoSet)) {
+                if (timed) measure(infoSet);
+                else infoSet.calculate<Width>(engine);
+                store(infoSet);
+            }
+            record(infoSet, i);
+        }
+        break;
+    case TimingMode::BLOCK:
+    case TimingMode::INTERLEAVED:
+        //inputs are generated before each block's timer starts, and reported and recorded after it stops
+        std::array<FactorCalculationInfo, maxTimingBlock> block;
+        //the misses of an interleaved block, gathered to be factored together
+        std::array<uint64_t, maxTimingBlock> missInputs;
+        std::array<Factorization, maxTimingBlock> missFactorizations;
+        //cache hits are found before the timer starts too, and the block's time is amortized over its misses only
+        for (uint64_t blockStart { firstIndex }; blockStart <= lastIndex; blockStart += timingInterval) {
+            const size_t blockCount { std::min(timingInterval, (lastIndex - blockStart) + 1) };
+            size_t missCount { 0 };
+            for (size_t j { 0 }; j < blockCount; ++j) {
+                block[j].n = inputAt(blockStart + j);
+                if (!lookUp(block[j])) missInputs[missCount++] = block[j].n;
+            }
 
-        //displays the number before calculation begins to give user info about why the program may be taking longer on a factorization
-        //e.g. if a large coprime with factors of similar but inequal value is generated as input
-        if (reportIndividualFactorizations) //display the number generated
-            std::println("({}/{}): {}", i, inputCount, infoSet.n);
-        else if (yieldsNewIntegerPercentage(i, inputCount)) 
-            //ANSI line clear refreshes completion %  
-            std::println("\033[A\33[2K\r{}%", 100 * i / inputCount);
+            const HardwareCounts countsBefore { collectHardwareCounters ? PerfCounters::forThisThread().read() : HardwareCounts() };
+            #ifdef COUNT_OPERATIONS
+            if (timingMode == TimingMode::INTERLEAVED) OperationCounter::take();
+            #endif
+            const uint64_t start { TscClock::start() };
+            if (timingMode == TimingMode::BLOCK) {
+                for (size_t j { 0 }; j < blockCount; ++j) if (!block[j].isCacheHit()) block[j].calculate<Width>(engine);
+            }
+            else primes::factorBatch(std::span(missInputs).first(missCount), missFactorizations);
+            const uint64_t blockTicks { TscClock::stop() - start };
+            //rounded to the nearest tick
+            const uint64_t amortizedCalcTicks { (blockTicks + missCount / 2) / std::max(missCount, size_t { 1 }) };
+            const HardwareCounts amortizedCounts { collectHardwareCounters ? (PerfCounters::forThisThread().read() - countsBefore) / std::max(missCount, size_t { 1 }) : HardwareCounts() };
+            #ifdef COUNT_OPERATIONS
+            //the lanes of an interleaved block share their operations, so each input is given the block's mean
+            const OperationCounts amortizedOperations { timingMode == TimingMode::INTERLEAVED ? OperationCounter::take() / std::max(missCount, size_t { 1 }) : OperationCounts() };
+            #endif
+            if (missCount) shard.handleNewBatchData(missCount, blockTicks);
 
-        infoSet.calculateAndTime();
+            for (size_t j { 0 }, missIndex { 0 }; j < blockCount; ++j) {
+                if (block[j].isCacheHit()) {
+                    block[j].calcTicks = TscClock::untimed;
+                    block[j].hardwareCounts = HardwareCounts();
+                    #ifdef COUNT_OPERATIONS
+                    //block entries are reused, so would otherwise keep the counts of the last input factored in this slot
+                    block[j].operationCounts = OperationCounts();
+                    #endif
+                }
+                else {
+                    block[j].calcTicks = amortizedCalcTicks;
+                    block[j].hardwareCounts = amortizedCounts;
+                    if (timingMode == TimingMode::INTERLEAVED) {
+                        block[j].factorization = missFactorizations[missIndex++];
+                        #ifdef COUNT_OPERATIONS
+                        block[j].operationCounts = amortizedOperations;
+                        #endif
+                    }
+                    store(block[j]);
+                }
+                record(block[j], blockStart + j);
+            }
+        }
+        break;
+    }
+}
+
+FactorCache* FactorizationCalculator::getFactorCache(const unsigned worker) {
+    return factorCaches.empty() ? nullptr : &factorCaches[worker];
+}
+
+void FactorizationCalculator::processInParallel(const uint64_t chunkSize, const uint64_t count, const std::function<void(const unsigned, StatSet&, const uint64_t, const uint64_t)>& processInputs) {
+    if (shards.empty()) {
+        shards.reserve(pool->getThreadCount());
+        for (unsigned i { 0 }; i < pool->getThreadCount(); ++i) shards.emplace_back(expectedInputCount);
+    }
+    //batch mode's total is unknown until its input has been parsed
+    const uint64_t total { mode == InputMode::BATCH ? 0 : inputCount };
 
-        //prints out the individual factorization and respective calculation time
-        if (reportIndividualFactorizations) infoSet.printPostCalcInfo();
+    //each worker republishes its shard's live summary after every chunk, for whichever worker next prints the live stats line
+    struct alignas(64) PublishedSummary {
+        SeqLock<LiveSummary> summary;
+    };
+    const std::unique_ptr<PublishedSummary[]> published { std::make_unique<PublishedSummary[]>(pool->getThreadCount()) };
+    std::mutex liveLineLock;
+    const auto start { std::chrono::steady_clock::now() };
+    auto lastLiveLine { start };
 
-        stats->handleNewFactorizationData(std::move(infoSet));
+    std::atomic<uint64_t> completedCount { completedInputs };
+    pool->run(count / chunkSize + (count % chunkSize != 0), [&](const unsigned worker, const uint64_t chunk) {
+        const uint64_t firstIndex { chunk * chunkSize + 1 }, lastIndex { std::min(firstIndex + chunkSize - 1, count) };
+        processInputs(worker, shards[worker], firstIndex, lastIndex);
+        const uint64_t chunkCount { (lastIndex - firstIndex) + 1 }, completed { completedCount += chunkCount };
+        if (telemetry) telemetry->publish(worker, chunkCount, shards[worker]);
+        if (reportIndividualFactorizations) return chunkCount;
+
+        published[worker].summary.store(shards[worker].getLiveSummary());
+        //refreshed on every new integer percentage, or periodically for runs where a percent takes a long time
+        //a worker that finds another already printing skips its turn rather than waiting
+        std::unique_lock liveLine(liveLineLock, std::try_to_lock);
+        const auto now { std::chrono::steady_clock::now() };
+        if (liveLine && ((total && 100 * completed / total != 100 * (completed - chunkCount) / total) || now - lastLiveLine >= liveLineInterval)) {
+            LiveSummary summary;
+            for (unsigned i { 0 }; i < pool->getThreadCount(); ++i) summary.merge(published[i].summary.load());
+            //ANSI line clear refreshes the live stats line
+            std::println("{}{}", rewriteLineEscape(), formatLiveSummary(summary, completedCount, total, now - start));
+            lastLiveLine = now;
+        }
+        return chunkCount;
+    });
+    if (reportIndividualFactorizations) ReportWriter::flushAll();
+    if (telemetry) telemetry->publishAll(shards);
+    completedInputs += count;
+}
+
+void FactorizationCalculator::printTimingReport(FILE* outStream) const {
+    printDivider("Timing", outStream);
+    std::println(outStream, "Timer: {} | Overhead: {} ticks ({:.1f}ns), included in every time measured", 
+        TscClock::describeSource(), TscClock::getOverheadTicks(), TscClock::ticksToNanos(TscClock::getOverheadTicks()));
+    switch (timingMode) {
+    case TimingMode::EVERY_INPUT:
+        std::println(outStream, "Every input timed individually");
+        break;
+    case TimingMode::SAMPLED:
+        std::println(outStream, "1 in every {} inputs timed individually ({} of {})", timingInterval, stats->getTimedCount(), inputCount);
+        break;
+    case TimingMode::BLOCK:
+        std::println(outStream, "Inputs timed in blocks of up to {}, each given its block's mean time (overhead per input at most {:.3f}ns)", 
+            timingInterval, TscClock::ticksToNanos(TscClock::getOverheadTicks()) / timingInterval);
+        break;
+    case TimingMode::INTERLEAVED:
+        std::println(outStream, "Inputs factored together in blocks of up to {}, {} at a time in lockstep, each given its block's mean time (overhead per input at most {:.3f}ns)", 
+            timingInterval, primes::defaultInterleavedLanes, TscClock::ticksToNanos(TscClock::getOverheadTicks()) / timingInterval);
+        break;
     }
 }
 
-inline bool yieldsNewIntegerPercentage(uint64_t n, uint64_t total) {
-    return 100 * n / total != 100 * (n - 1) / total || n == 1;
+void FactorizationCalculator::printThreadReport(FILE* outStream) const {
+    printDivider("Per Thread Throughput", outStream);
+    const auto& reports { pool->viewReports() };
+    const auto formatReport = [&](const size_t i) {
+        return std::format("Thread {}: {} inputs ({:.0f}/sec) | {} chunks ({} stolen)", i, reports[i].inputsProcessed, 
+            reports[i].busyTime.count() ? reports[i].inputsProcessed / reports[i].busyTime.count() : 0.L, reports[i].chunksProcessed, reports[i].chunksStolen);
+    };
+    //two threads per line
+    for (size_t i { 0 }; i < reports.size(); i += 2) 
+        std::println(outStream, "{:{}}{}", formatReport(i), panelWidth, i + 1 < reports.size() ? formatReport(i + 1) : "");
 }
@@ -1,30 +1,81 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <cstdint>
 #include <chrono>
 #include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <iostream>
 #include <cstdio>
 #include <print>
 #include <string>
+#include <string_view>
 #include <random>
+#include <stdexcept>
 #include <optional>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 #include "statset.hpp"
+#include "perfcounters.hpp"
 #include "primes.hpp"
+#include "batchinput.hpp"
 #include "calculationinfo.hpp"
+#include "factorcache.hpp"
+#include "interleavedfactorization.hpp"
+#include "rangesieve.hpp"
+#include "reportwriter.hpp"
+#include "splitmix64.hpp"
+#include "telemetry.hpp"
+#include "tieredfactorization.hpp"
+#include "utils.hpp"
+#include "workstealingpool.hpp"
 
+//modes selectable from the interactive prompt; BATCH is selected by command line arguments instead
 static constexpr int modeCount = 3;
 
 enum class InputMode {
-    MANUAL, RANDOM, RANGE
+    MANUAL, RANDOM, RANGE, BATCH
+};
+
+static constexpr int timingModeCount = 4;
+
+//which inputs have their calculation times measured, and how
+//SAMPLED times one in every timingInterval inputs; BLOCK times blocks of timingInterval inputs, giving each the block's mean
+//INTERLEAVED is BLOCK with each block factored together by primes::factorBatch, for the tiered engine only
+enum class TimingMode {
+    EVERY_INPUT, SAMPLED, BLOCK, INTERLEAVED
 };
 
 class FactorizationCalculator {
 public:
     FactorizationCalculator();
+    //headless batch mode, configured by command line arguments (excluding the program name) as described in batchUsage
+    //throws std::invalid_argument for malformed arguments, or std::runtime_error if the input cannot be opened
+    FactorizationCalculator(const std::vector<std::string_view>& args);
     void run(void);
+
+    static constexpr const char* batchUsage = 
+        "usage: primeFactor.exe --batch <file, or - for stdin> [--engine trial|rho|tiered] [--threads <count, 0 for all>]\n"
+        "                       [--table-bound <bound>] [--cache-table] [--report] [--plain] [--sample-timing <k> | --block-timing <k> | --interleave <k>]\n"
+        "                       [--counters] [--cache <entries per thread>] [--cache-file <path>] [--telemetry <port> | --telemetry-socket <path>]\n"
+        "factors whitespace or comma separated numbers below 2^64, then prints statistics as the interactive modes do\n"
+        "--plain omits ANSI escape sequences, as is the default when stdout is not a terminal\n"
+        "--sample-timing times only 1 in every k inputs; --block-timing times blocks of k (at most 64) inputs, reporting each block's mean\n"
+        "--interleave factors blocks of k (at most 64) inputs together, stepping several at once in lockstep, and reports each block's mean (tiered engine only)\n"
+        "--counters counts cycles, instructions, branch misses and cache misses wherever inputs are timed, if perf events are permitted\n"
+        "--cache keeps recent factorizations in memory, and --cache-file keeps every factorization in a table shared between runs; hits are not timed\n"
+        "--telemetry serves live statistics at http://127.0.0.1:<port>/metrics (prometheus) and /metrics.json, and --telemetry-socket on a unix socket";
 private:
+    //constructs everything that depends on the settings
+    //precondition: every setting is set
+    void applySettings(const uint64_t expectedInputCount_);
+
     //prompts the user to select a mode for the calculator to run in
     void promptForMode(void);
 
@@ -41,14 +92,92 @@ private:
     //inputs every value from minN to maxN in order
     void rangeBasedInputTest();
 
+    //factors every value from minN to maxN in sieved blocks; see RangeSieve
+    void sievedRangeInputTest();
+
+    //factors every number in batchInput, parsing each batch while the previous one is factored
+    void batchInputTest();
+
+    //factors inputAt(i) for each i from firstIndex through lastIndex in order, timing them as timingMode dictates, and records them in shard
+    //reports are numbered from reportOffset + firstIndex, out of reportTotal (0 if unknown)
+    //Width is as in FactorCalculationInfo::calculateAndTime
+    //inputs are looked up in cache first, unless it is nullptr
+    template<class Width, class InputSource>
+    void factorInputs(StatSet& shard, FactorCache* cache, const uint64_t firstIndex, const uint64_t lastIndex, const uint64_t reportOffset, const uint64_t reportTotal, const InputSource& inputAt);
+
+    //the worker's cache, or nullptr if caching is off
+    FactorCache* getFactorCache(const unsigned worker);
+
+    //splits inputs 1 through count into chunks of chunkSize, which are distributed between the pool's threads
+    //processInputs(worker, shard, firstIndex, lastIndex) handles inputs firstIndex through lastIndex inclusive, recording them in the calling worker's shard
+    //may be called several times per run, e.g. once per batch; shards are merged into stats by run once the mode has finished
+    void processInParallel(const uint64_t chunkSize, const uint64_t count, const std::function<void(const unsigned, StatSet&, const uint64_t, const uint64_t)>& processInputs);
+
+    //outputs the input count and throughput of each thread in the pool
+    void printThreadReport(FILE* outStream = stdout) const;
+
+    //outputs the timer used, its overhead, and which inputs were timed
+    void printTimingReport(FILE* outStream = stdout) const;
+
     InputMode mode;
+    primes::Engine engine;
     uint64_t inputCount, minN, maxN;
+    //inputCount, or an upper bound on it where it is not known ahead of time; sizes each StatSet's record lists
+    uint64_t expectedInputCount;
     bool reportIndividualFactorizations;
+    bool sieveRange;
+    //every input fits in 32 bits, so factorizations can use 32 bit arithmetic without checking each input
+    bool narrowInputs;
+    unsigned threadCount;
+    uint64_t primeTableBound;
+    bool cachePrimeTable;
+    primes::TierCrossovers tierCrossovers;
+    TimingMode timingMode;
+    uint64_t timingInterval;
+    //count hardware events with PerfCounters wherever inputs are timed; cleared by applySettings if perf events are unavailable
+    bool collectHardwareCounters;
+
+    static constexpr const char* primeTableCachePath = "primetable.bin";
+
+    //factorizations kept in memory per thread; caching is off if this is 0 and factorStorePath is empty
+    uint64_t factorCacheCapacity;
+    //FactorStore file, or empty for none
+    std::string factorStorePath;
+    static constexpr const char* defaultFactorStorePath = "factorcache.bin";
+    //reset by applySettings if the file cannot be used
+    std::optional<FactorStore> factorStore;
+    //one per thread, each backed by factorStore if there is one; empty if caching is off
+    std::vector<FactorCache> factorCaches;
+
+    //port on 127.0.0.1 to serve live statistics on, or 0 for none; see TelemetryServer
+    uint16_t telemetryPort;
+    //unix domain socket to serve them on instead, or empty for none
+    std::string telemetrySocketPath;
+    //reset by applySettings if the endpoint cannot be bound
+    std::optional<TelemetryServer> telemetry;
     
     //collection of stats from calculation time data
     //stores a flexible number of records in a few timeCategories based on the log of the count, with a minimum of 3
     //optional to postpone construction until settings have been set
     std::optional<StatSet> stats;
+    //one per thread, each only ever accessed by its own thread until merged into stats
+    std::vector<StatSet> shards;
+    //inputs processed by processInParallel so far this run
+    uint64_t completedInputs = 0;
+
+    //source of inputs in batch mode
+    std::optional<BatchInput> batchInput;
+    //inputs parsed at a time in batch mode
+    static constexpr size_t batchSize = 1u << 18;
+
+    //optional to postpone construction until threadCount has been set
+    std::optional<WorkStealingPool> pool;
+    //inputs per chunk handed out to threads; small enough that a few pathologically slow inputs cannot leave other threads idle for long
+    static constexpr uint64_t defaultChunkSize = 64;
+    //blocks are timed within a single chunk, and held on the stack while they are factored
+    static constexpr uint64_t maxTimingBlock = defaultChunkSize;
+    //longest the live stats line goes without refreshing, given inputs are still completing
+    static constexpr std::chrono::seconds liveLineInterval { 1 };
 };
 
 //accept any valid input that can be stored in type T unless otherwise specified
@@ -66,6 +195,3 @@ inline T promptIndividualSetting(std::string&& prompt, const std::function<bool(
     } while (!acceptCondition(setting));
     return setting;
 }
-
-//n assumed to start at 1
-inline bool yieldsNewIntegerPercentage(uint64_t n, uint64_t total);
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "fastdivisor.hpp"
+
+#include <stdexcept>
+
+constexpr std::array<FastDivisor, primes::smallFastDivisorCount> primes::smallFastDivisors { []{
+    std::array<bool, smallFastDivisorBound> isComposite {};
+    std::array<FastDivisor, smallFastDivisorCount> divisors;
+    size_t i { 0 };
+    for (uint64_t p { 3 }; p < smallFastDivisorBound; p += 2) {
+        if (isComposite[p]) continue;
+        //too few array elements fails compilation here by indexing out of bounds
+        divisors[i++] = FastDivisor(p);
+        for (uint64_t multiple { p * p }; multiple < smallFastDivisorBound; multiple += 2 * p) isComposite[multiple] = true;
+    }
+    //and too many fails compilation here, since throwing is not a constant expression
+    if (i != smallFastDivisorCount) throw std::logic_error("smallFastDivisorCount is wrong");
+    return divisors;
+}() };
+
+constexpr std::array<uint8_t, primes::smallFastDivisorBound / 2> primes::smallestOddFactors { []{
+    std::array<uint8_t, smallFastDivisorBound / 2> factors {};
+    //ascending, so each odd multiple is marked by its least prime factor first
+    for (uint64_t p { 3 }; p * p < smallFastDivisorBound; p += 2) {
+        if (factors[p / 2]) continue;
+        for (uint64_t multiple { p * p }; multiple < smallFastDivisorBound; multiple += 2 * p) 
+            if (!factors[multiple / 2]) factors[multiple / 2] = p;
+    }
+    return factors;
+}() };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//replaces hardware division by a fixed odd divisor with multiplication by its inverse mod 2^64
+//n is divisible by d iff q = n * d^-1 (mod 2^64) satisfies q * d < 2^64 (i.e. the high half of the full product is 0),
+//in which case q is exactly n / d
+//trial division only ever needs to know whether a prime divides n and, if so, the quotient, so no general purpose modulo is provided
+class FastDivisor {
+public:
+    //precondition: divisor_ is odd
+    constexpr explicit FastDivisor(const uint64_t divisor_ = 1) : divisor(divisor_), inverse(modularInverse(divisor_)) {}
+    //from an inverse computed earlier, e.g. one cached by PrimeTable
+    //precondition: inverse_ == modularInverse(divisor_)
+    constexpr FastDivisor(const uint64_t divisor_, const uint64_t inverse_) : divisor(divisor_), inverse(inverse_) {}
+
+    constexpr bool divides(const uint64_t n) const { return !mulHigh(n * inverse, divisor); }
+    //precondition: divides(n)
+    constexpr uint64_t divideExact(const uint64_t n) const { return n * inverse; }
+
+    constexpr uint64_t getDivisor(void) const { return divisor; }
+    constexpr uint64_t getInverse(void) const { return inverse; }
+
+    //d^-1 mod 2^64; (3d) xor 2 is correct to 5 bits, and each step doubles the number of correct bits
+    //equivalent to newton's method, but the error term y is squared independently of x, halving the dependency chain
+    //precondition: d is odd
+    static constexpr uint64_t modularInverse(const uint64_t d) {
+        uint64_t x { (3 * d) ^ 2 }, y { 1 - d * x };
+        for (int i = 0; i < 4; ++i, y *= y) x *= 1 + y;
+        return x;
+    }
+
+private:
+    static constexpr uint64_t mulHigh(const uint64_t a, const uint64_t b) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+    }
+
+    uint64_t divisor, inverse;
+};
+
+namespace primes {
+    static constexpr uint64_t smallFastDivisorBound = 1u << 16;
+
+    //there are 6541 odd primes below 2^16
+    static constexpr size_t smallFastDivisorCount = 6541;
+
+    //FastDivisors for every odd prime below smallFastDivisorBound, in ascending order, generated at compile time
+    //inverses of the primes in the prime table beyond it are cached by PrimeTable, see PrimeTable::viewInverses
+    //defined in fastdivisor.cpp so that the table is only evaluated once per build
+    extern const std::array<FastDivisor, smallFastDivisorCount> smallFastDivisors;
+
+    //smallestOddFactors[n / 2] is the least prime factor of odd n below smallFastDivisorBound, or 0 if n is prime or 1
+    //a composite n below 2^16 has a factor below 2^8, so each fits in a byte; likewise generated at compile time and defined in fastdivisor.cpp
+    extern const std::array<uint8_t, smallFastDivisorBound / 2> smallestOddFactors;
+}
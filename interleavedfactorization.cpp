@@ -0,0 +1,342 @@
+#include "interleavedfactorization.hpp"
+#include "opcounter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <vector>
+#include "montgomery.hpp"
+
+//a factor of inputs[owner] still to be tested or split, which divides it exp times over
+struct Cofactor {
+    uint64_t m;
+    unsigned exp;
+    size_t owner;
+};
+
+//every cofactor of the batch, by what is known of it so far
+struct CofactorQueues {
+    std::vector<Cofactor> untested, composite, prime;
+};
+
+//settles a cofactor outright where that takes no modular multiplications, as tieredFactorization does, and otherwise queues it to be tested
+static void classify(Cofactor cofactor, CofactorQueues& queues) {
+    const TrialDivisionKernel& kernel { TrialDivisionKernel::get() };
+    while (true) {
+        const auto [root, rootExp] { primes::perfectPower(cofactor.m, primes::tieredTrialBound) };
+        cofactor.m = root;
+        cofactor.exp *= rootExp;
+
+        //no factor of m is below tieredTrialBound, so it must be prime if it is below its square
+        if (primes::tieredTrialBound > primes::isqrt(cofactor.m)) {
+            queues.prime.push_back(cofactor);
+            return;
+        }
+        if (static_cast<unsigned>(std::bit_width(cofactor.m)) > primes::getTierCrossovers().trialDivisionMaxBits) {
+            queues.untested.push_back(cofactor);
+            return;
+        }
+        //trial division is cheaper than a primality test at this size, and finds the smallest factor outright
+        const size_t i { kernel.findDivisor(cofactor.m, 0, primes::isqrt(cofactor.m)) };
+        if (i == kernel.getPrimeCount()) {
+            queues.prime.push_back(cofactor);
+            return;
+        }
+        queues.prime.push_back({ kernel.getPrime(i), cofactor.exp, cofactor.owner });
+        cofactor.m /= kernel.getPrime(i);
+    }
+}
+
+//miller-rabin on one untested cofactor at a time, with the same bases as isPrimeMillerRabin
+//base^d is raised two bits at a time from the top, multiplying by a table of base^0 through base^3, so that every lane takes the same
+//multiplications in every step rather than only multiplying on the set bits of its own d
+class PrimalityLane {
+public:
+    //takes untested cofactors until one needs stepping, returning false if none is left
+    bool load(CofactorQueues& queues) {
+        while (!queues.untested.empty()) {
+            cofactor = queues.untested.back();
+            queues.untested.pop_back();
+            OperationCounter::countPrimalityTest();
+            const uint64_t n { cofactor.m };
+            mont.emplace(n);
+            one = mont->toMont(1);
+            minusOne = mont->toMont(n - 1);
+            s = static_cast<unsigned>(std::countr_zero(n - 1));
+            d = (n - 1) >> s;
+            base = 0;
+            if (startBase(queues)) return true;
+        }
+        return false;
+    }
+
+    //precondition: i < stepsLeft, and i is one more than at the previous step since the last call to skip
+    void step(const uint64_t i) {
+        x = mont->mul(x, x);
+        if (!squaring) {
+            x = mont->mul(x, x);
+            x = mont->mul(x, powers[(d >> (2 * (stepsLeft - 1 - i))) & 0b11]);
+        }
+    }
+
+    //steps to take before settle is next due
+    uint64_t getStepsLeft(void) const { return stepsLeft; }
+    //accounts for steps taken since the last call
+    void skip(const uint64_t steps) { 
+        stepsLeft -= steps;
+        if (squaring) squaringsLeft -= steps;
+    }
+
+    //moves the test on once stepsLeft reaches 0, returning false once the cofactor has been sorted
+    bool settle(CofactorQueues& queues) {
+        if (!squaring) return finishPower(queues);
+        if (x == minusOne) {
+            ++base;
+            return startBase(queues);
+        }
+        if (!squaringsLeft) {
+            sortComposite(queues);
+            return false;
+        }
+        stepsLeft = 1;
+        return true;
+    }
+
+private:
+    bool startBase(CofactorQueues& queues) {
+        //a base that is a multiple of n says nothing about n's primality
+        for (; base < primes::millerRabinBases64.size() && primes::millerRabinBases64[base] % cofactor.m == 0; ++base);
+        if (base == primes::millerRabinBases64.size()) {
+            queues.prime.push_back(cofactor);
+            return false;
+        }
+        powers[0] = one;
+        powers[1] = mont->toMont(primes::millerRabinBases64[base]);
+        powers[2] = mont->mul(powers[1], powers[1]);
+        powers[3] = mont->mul(powers[2], powers[1]);
+
+        //the top digit of d is never 0
+        const unsigned digits { (static_cast<unsigned>(std::bit_width(d)) + 1) / 2 };
+        x = powers[(d >> (2 * (digits - 1))) & 0b11];
+        squaring = false;
+        stepsLeft = digits - 1;
+        return stepsLeft || finishPower(queues);
+    }
+
+    //x is now base^d
+    bool finishPower(CofactorQueues& queues) {
+        if (x == one || x == minusOne) {
+            ++base;
+            return startBase(queues);
+        }
+        if (s == 1) {
+            sortComposite(queues);
+            return false;
+        }
+        squaring = true;
+        squaringsLeft = s - 1;
+        stepsLeft = 1;
+        return true;
+    }
+
+    //composites the crossovers give to hart's method or squfof are split here, and the rest queued for rho
+    void sortComposite(CofactorQueues& queues) {
+        const unsigned bits { static_cast<unsigned>(std::bit_width(cofactor.m)) };
+        const primes::TierCrossovers& crossovers { primes::getTierCrossovers() };
+        if (bits > crossovers.oneLineMaxBits && bits > crossovers.squfofMaxBits) {
+            queues.composite.push_back(cofactor);
+            return;
+        }
+        const uint64_t factor { primes::splitCofactor(cofactor.m) };
+        classify({ factor, cofactor.exp, cofactor.owner }, queues);
+        classify({ cofactor.m / factor, cofactor.exp, cofactor.owner }, queues);
+    }
+
+    std::optional<Montgomery64> mont;
+    Cofactor cofactor;
+    uint64_t one, minusOne, d, x;
+    std::array<uint64_t, 4> powers;
+    unsigned s;
+    //index into millerRabinBases64
+    size_t base;
+    bool squaring;
+    uint64_t stepsLeft;
+    unsigned squaringsLeft;
+};
+
+//pollard-brent rho on one composite cofactor at a time, taking the same steps as primes::pollardBrent
+class SplittingLane {
+public:
+    //takes the next composite cofactor, returning false if none is left
+    bool load(CofactorQueues& queues) {
+        if (queues.composite.empty()) return false;
+        cofactor = queues.composite.back();
+        queues.composite.pop_back();
+        mont.emplace(cofactor.m);
+        one = mont->toMont(1);
+        c = one;
+        startWalk();
+        return true;
+    }
+
+    void step(const uint64_t) {
+        y = f(y);
+        if (accumulating) q = mont->mul(q, x > y ? x - y : y - x);
+    }
+
+    uint64_t getStepsLeft(void) const { return stepsLeft; }
+    void skip(const uint64_t steps) { stepsLeft -= steps; }
+
+    bool settle(CofactorQueues& queues) {
+        if (!accumulating) {
+            accumulating = true;
+            k = 0;
+            startGcdBatch();
+            return true;
+        }
+        //montgomery form multiplies by R, which is coprime to n, so the gcd is unaffected
+        uint64_t g { std::gcd(q, cofactor.m) };
+        if (g == 1) {
+            if (k < r) startGcdBatch();
+            else {
+                x = y;
+                r <<= 1;
+                accumulating = false;
+                stepsLeft = r;
+            }
+            return true;
+        }
+        //the batch overshot, so its steps are retraced one gcd at a time, which is rare enough to be left out of the lockstep
+        if (g == cofactor.m) {
+            do {
+                ys = f(ys);
+                g = std::gcd(x > ys ? x - ys : ys - x, cofactor.m);
+            } while (g == 1);
+        }
+        if (g != cofactor.m) return split(g, queues);
+        //a cycle mod n rather than mod a factor, so the walk starts over with a new c
+        c = mont->add(c, one);
+        startWalk();
+        return true;
+    }
+
+private:
+    //number of steps whose differences are multiplied together before taking a single gcd, as in primes::pollardBrent
+    static constexpr uint64_t gcdBatchSize = 128;
+
+    uint64_t f(const uint64_t v) const { return mont->add(mont->mul(v, v), c); }
+
+    void startWalk(void) {
+        y = mont->toMont(2);
+        x = y;
+        q = one;
+        r = 1;
+        accumulating = false;
+        stepsLeft = r;
+    }
+
+    void startGcdBatch(void) {
+        ys = y;
+        stepsLeft = std::min(gcdBatchSize, r - k);
+        k += stepsLeft;
+    }
+
+    bool split(const uint64_t factor, CofactorQueues& queues) {
+        classify({ factor, cofactor.exp, cofactor.owner }, queues);
+        classify({ cofactor.m / factor, cofactor.exp, cofactor.owner }, queues);
+        return false;
+    }
+
+    std::optional<Montgomery64> mont;
+    Cofactor cofactor;
+    uint64_t one, c, x, y, ys, q;
+    //length of the current stretch of the walk, and steps of it accumulated so far
+    uint64_t r, k;
+    //multiplying differences into q, rather than advancing y to the start of the stretch
+    bool accumulating;
+    uint64_t stepsLeft;
+};
+
+//steps up to laneCount lanes in lockstep until their queue runs dry, giving each lane the next cofactor as soon as it sorts its own
+template<class Lane, size_t laneCount>
+static void runLanes(CofactorQueues& queues) {
+    std::array<Lane, laneCount> lanes;
+    //indices of the lanes with work, in no particular order
+    std::array<size_t, laneCount> busy;
+    size_t busyCount { 0 };
+    for (size_t i { 0 }; i < laneCount && lanes[i].load(queues); ++i) busy[busyCount++] = i;
+
+    while (busyCount) {
+        //every busy lane can take this many steps before any of them needs settling, so they are taken without checking on any lane
+        uint64_t steps { std::numeric_limits<uint64_t>::max() };
+        for (size_t j { 0 }; j < busyCount; ++j) steps = std::min(steps, lanes[busy[j]].getStepsLeft());
+        for (uint64_t i { 0 }; i < steps; ++i)
+            for (size_t j { 0 }; j < busyCount; ++j) lanes[busy[j]].step(i);
+        for (size_t j { 0 }; j < busyCount; ++j) lanes[busy[j]].skip(steps);
+
+        for (size_t j { 0 }; j < busyCount; ) {
+            Lane& lane { lanes[busy[j]] };
+            if (lane.getStepsLeft() || lane.settle(queues) || lane.load(queues)) ++j;
+            else busy[j] = busy[--busyCount];
+        }
+    }
+}
+
+template<size_t laneCount>
+void primes::factorBatch(std::span<const uint64_t> inputs, std::span<Factorization> factorizations) {
+    static_assert(laneCount >= 1);
+    CofactorQueues queues;
+
+    //as tieredFactorization, up to where it would test or split what is left of each input
+    for (size_t i { 0 }; i < inputs.size(); ++i) {
+        Factorization& foundFactors { factorizations[i] };
+        foundFactors = Factorization();
+        uint64_t n { inputs[i] };
+        //0 and 1 have no prime factorization
+        if (n < 2ull) continue;
+
+        {
+            const OperationCounter::StageScope stage(OperationCounts::POWERS_OF_TWO);
+            if (const unsigned exp { static_cast<unsigned>(std::countr_zero(n)) }) {
+                n >>= exp;
+                foundFactors.addNewFactor(2, exp);
+            }
+        }
+        if (static_cast<unsigned>(std::bit_width(n)) <= getTierCrossovers().trialDivisionMaxBits) {
+            divideOutTablePrimes(n, foundFactors, std::numeric_limits<uint64_t>::max());
+            if (n > 1ull) foundFactors.addNewFactor(n, 1);
+            continue;
+        }
+        divideOutTablePrimes(n, foundFactors, tieredTrialBound);
+        if (n > 1ull) classify({ n, 1, i }, queues);
+    }
+
+    //splitting a composite gives two more cofactors to test, so the two stages alternate until every cofactor is prime
+    while (!queues.untested.empty() || !queues.composite.empty()) {
+        {
+            const OperationCounter::StageScope stage(OperationCounts::PRIMALITY);
+            runLanes<PrimalityLane, laneCount>(queues);
+        }
+        const OperationCounter::StageScope stage(OperationCounts::SPLITTING);
+        runLanes<SplittingLane, laneCount>(queues);
+    }
+
+    //factors are found in no particular order, so they are sorted by input, then ascending to match tieredFactorization
+    //the same prime may have been found in more than one cofactor of an input
+    std::sort(queues.prime.begin(), queues.prime.end(), [](const Cofactor& a, const Cofactor& b) {
+        return a.owner != b.owner ? a.owner < b.owner : a.m < b.m;
+    });
+    for (size_t i { 0 }, j; i < queues.prime.size(); i = j) {
+        unsigned totalExp { 0 };
+        for (j = i; j < queues.prime.size() && queues.prime[j].owner == queues.prime[i].owner && queues.prime[j].m == queues.prime[i].m; ++j)
+            totalExp += queues.prime[j].exp;
+        factorizations[queues.prime[i].owner].addNewFactor(queues.prime[i].m, totalExp);
+    }
+}
+
+template void primes::factorBatch<4>(std::span<const uint64_t>, std::span<Factorization>);
+template void primes::factorBatch<8>(std::span<const uint64_t>, std::span<Factorization>);
+template void primes::factorBatch<16>(std::span<const uint64_t>, std::span<Factorization>);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "factorization.hpp"
+#include "primes.hpp"
+#include "tieredfactorization.hpp"
+
+//the tiered engine run over many inputs at once
+//a miller-rabin test or a rho walk is a single chain of modular multiplications, each waiting on the one before, which leaves most of
+//a core's multipliers idle; factorBatch instead steps laneCount independent tests or walks in lockstep, so that the multiplications of
+//different lanes overlap, and gives a lane the next waiting cofactor from any input as soon as its own is done
+namespace primes {
+    //scalar tests and walks already overlap about two chains, so more lanes gain less than they might; 4 was fastest measured, at up to about 1.3x
+    static constexpr size_t defaultInterleavedLanes = 4;
+
+    //sets factorizations[i] to primeFactorization(inputs[i], Engine::TIERED) for each i, under the current tier crossovers
+    //only primality tests and rho are interleaved; cofactors that the crossovers give to hart's method or squfof are split one at a time
+    //laneCount is 4, 8 or 16
+    //precondition: factorizations.size() >= inputs.size()
+    template<size_t laneCount = defaultInterleavedLanes>
+    void factorBatch(std::span<const uint64_t> inputs, std::span<Factorization> factorizations);
+}
@@ -0,0 +1,93 @@
+#include "latencyhistogram.hpp"
+
+void LatencyHistogram::record(const uint64_t ns) {
+    ++counts[bucketIndex(ns)];
+    ++totalCount;
+    min = std::min(min, ns);
+    max = std::max(max, ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i { 0 }; i < bucketCount; ++i) counts[i] += other.counts[i];
+    totalCount += other.totalCount;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+uint64_t LatencyHistogram::getCount(void) const {
+    return totalCount;
+}
+
+uint64_t LatencyHistogram::getMin(void) const {
+    return totalCount ? min : 0;
+}
+
+uint64_t LatencyHistogram::getMax(void) const {
+    return max;
+}
+
+long double LatencyHistogram::valueAtQuantile(const double q) const {
+    if (totalCount < 2) 
+        return getMin();
+    const long double pos = (totalCount - 1) * static_cast<long double>(q);
+    const uint64_t lower = static_cast<uint64_t>(pos);
+    const long double lowerValue = valueAtRank(lower);
+    if (lower + 1 >= totalCount) return lowerValue;
+    return lowerValue + (pos - lower) * (valueAtRank(lower + 1) - lowerValue);
+}
+
+long double LatencyHistogram::meanBetweenQuantiles(const double low, const double high) const {
+    const long double lowRank = totalCount * static_cast<long double>(low), highRank = totalCount * static_cast<long double>(high);
+    if (highRank <= lowRank) return valueAtQuantile(low);
+
+    //each bucket contributes its midpoint once per rank it shares with [lowRank, highRank), counting partially covered ranks fractionally
+    long double sum { 0 };
+    uint64_t ranksBefore { 0 };
+    forEachBucket([&](const long double midpoint, const uint64_t count) {
+        const long double overlap = std::min<long double>(highRank, ranksBefore + count) - std::max<long double>(lowRank, ranksBefore);
+        if (overlap > 0) sum += overlap * midpoint;
+        ranksBefore += count;
+    });
+    return std::clamp<long double>(sum / (highRank - lowRank), getMin(), max);
+}
+
+uint64_t LatencyHistogram::countBelow(const uint64_t ns) const {
+    if (ns > max) return totalCount;
+    uint64_t below { 0 };
+    for (size_t i { 0 }, end { bucketIndex(ns) }; i < end; ++i) below += counts[i];
+    return below;
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t ns) {
+    ns = std::min(ns, (uint64_t(1) << maxTrackableBits) - 1);
+    //shift is 0 for the linear values below 2^subBucketBits, leaving (ns >> shift) in [2^(subBucketBits - 1), 2^subBucketBits) otherwise
+    const unsigned shift = std::max<unsigned>(std::bit_width(ns), subBucketBits) - subBucketBits;
+    return (size_t(shift) << (subBucketBits - 1)) + (ns >> shift);
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(const size_t index) {
+    if (index < (size_t(1) << subBucketBits)) return index;
+    const unsigned shift = (index >> (subBucketBits - 1)) - 1;
+    return uint64_t(index - (size_t(shift) << (subBucketBits - 1))) << shift;
+}
+
+uint64_t LatencyHistogram::bucketWidth(const size_t index) {
+    if (index < (size_t(1) << subBucketBits)) return 1;
+    return uint64_t(1) << ((index >> (subBucketBits - 1)) - 1);
+}
+
+long double LatencyHistogram::valueAtRank(const uint64_t rank) const {
+    //the extremes are tracked exactly
+    if (rank == 0) return getMin();
+    if (rank + 1 >= totalCount) return max;
+    uint64_t ranksBefore { 0 };
+    for (size_t i { 0 }; i < bucketCount; ++i) {
+        if (rank < ranksBefore + counts[i]) {
+            //spreads the bucket's values evenly across its width
+            const long double value = bucketLowerBound(i) + (bucketWidth(i) - 1) * ((rank - ranksBefore) + .5L) / counts[i];
+            return std::clamp<long double>(value, min, max);
+        }
+        ranksBefore += counts[i];
+    }
+    return max;
+}
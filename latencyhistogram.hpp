@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+//log-linear (HDR style) histogram of integer nanosecond durations
+//values below 2^subBucketBits get a bucket each; above that, every power of two is split into 2^(subBucketBits - 1) equal buckets,
+//so any value is known to within 1 part in 2^(subBucketBits - 1) of itself
+//memory is fixed regardless of how many values are recorded, and recording is O(1)
+class LatencyHistogram {
+public:
+    static constexpr unsigned subBucketBits = 7;
+    //values at or above 2^maxTrackableBits ns (about 73 minutes) are recorded in the last bucket; min and max stay exact
+    static constexpr unsigned maxTrackableBits = 42;
+    static constexpr size_t bucketCount = (maxTrackableBits - subBucketBits) * (size_t(1) << (subBucketBits - 1)) + (size_t(1) << subBucketBits);
+
+    void record(const uint64_t ns);
+    //adds the contents of other to this histogram
+    void merge(const LatencyHistogram& other);
+
+    uint64_t getCount(void) const;
+    uint64_t getMin(void) const;
+    uint64_t getMax(void) const;
+
+    //estimated value at fractional quantile q (0-1), interpolated between neighbouring ranks like a sorted list would be
+    long double valueAtQuantile(const double q) const;
+    //estimated mean of the values ranked between fractional quantiles low and high
+    long double meanBetweenQuantiles(const double low, const double high) const;
+    //number of recorded values below ns; exact when ns falls on a bucket boundary, otherwise within that bucket's width
+    uint64_t countBelow(const uint64_t ns) const;
+
+    //calls visit(midpoint, count) for every nonempty bucket, in ascending order
+    template<class Visitor>
+    void forEachBucket(Visitor&& visit) const;
+
+private:
+    static size_t bucketIndex(uint64_t ns);
+    static uint64_t bucketLowerBound(const size_t index);
+    static uint64_t bucketWidth(const size_t index);
+    //estimated value of the rank'th (0 based) smallest recorded value
+    long double valueAtRank(const uint64_t rank) const;
+
+    std::array<uint64_t, bucketCount> counts {};
+    uint64_t totalCount { 0 };
+    uint64_t min { std::numeric_limits<uint64_t>::max() };
+    uint64_t max { 0 };
+};
+
+template<class Visitor>
+void LatencyHistogram::forEachBucket(Visitor&& visit) const {
+    for (size_t i { 0 }; i < bucketCount; ++i) 
+        if (counts[i]) visit(bucketLowerBound(i) + (bucketWidth(i) - 1) / 2.L, counts[i]);
+}
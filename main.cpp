@@ -1,7 +1,20 @@
 #include "factorizationcalculator.hpp"
 
-int main(void) {
+int main(int argc, char** argv) {
+   //any arguments select headless batch mode
+   if (argc > 1) {
+      try {
+         FactorizationCalculator calc(std::vector<std::string_view>(argv + 1, argv + argc));
+         calc.run();
+      }
+      catch (const std::exception& e) {
+         std::println(stderr, "{}\n{}", e.what(), FactorizationCalculator::batchUsage);
+         return 1;
+      }
+      return 0;
+   }
+
    FactorizationCalculator calc;
    calc.run();
    return 0;
-}
\ No newline at end of file
+}
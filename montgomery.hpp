@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include "fastdivisor.hpp"
+#include "opcounter.hpp"
+
+//modular arithmetic in montgomery form for a fixed odd modulus, allowing mulmod without hardware division
+//all values passed to/returned by member functions (other than toMont/fromMont) are in montgomery form and in [0, n)
+//Word is uint32_t, uint64_t or unsigned __int128, with R == 2^(bits in Word)
+template<class Word>
+struct Montgomery {
+    static constexpr unsigned wordBits = sizeof(Word) * 8;
+
+    //precondition: n is odd
+    explicit Montgomery(const Word n_) : n(n_), nInv(inverse(n_)), r2(rSquaredModN(n_)) {}
+
+    Word toMont(const Word a) const { return mul(a % n, r2); }
+    Word fromMont(const Word a) const { return reduce(0, a); }
+
+    Word mul(const Word a, const Word b) const {
+        OperationCounter::countModularMultiplication();
+        Word high, low;
+        mulFull(a, b, high, low);
+        return reduce(high, low);
+    }
+
+    Word add(const Word a, const Word b) const {
+        //a + b may overflow when n is near R, so compare against the distance to n instead
+        return a >= n - b ? a - (n - b) : a + b;
+    }
+
+    Word sub(const Word a, const Word b) const { return a >= b ? a - b : a + (n - b); }
+
+    Word pow(Word base, Word exp) const {
+        Word result { toMont(1) };
+        for (; exp; exp >>= 1) {
+            if (exp & 0b1) result = mul(result, base);
+            base = mul(base, base);
+        }
+        return result;
+    }
+
+    const Word n;
+
+private:
+    //the full double width product of a and b, split into words
+    static void mulFull(const Word a, const Word b, Word& high, Word& low) {
+        if constexpr (wordBits < 128) {
+            using Wide = std::conditional_t<wordBits == 32, uint64_t, unsigned __int128>;
+            const Wide product { static_cast<Wide>(a) * b };
+            high = static_cast<Word>(product >> wordBits);
+            low = static_cast<Word>(product);
+        }
+        //no 256 bit type exists, so the product is assembled from 64 bit halves
+        else {
+            const uint64_t a0 { static_cast<uint64_t>(a) }, a1 { static_cast<uint64_t>(a >> 64) };
+            const uint64_t b0 { static_cast<uint64_t>(b) }, b1 { static_cast<uint64_t>(b >> 64) };
+            const Word p00 { static_cast<Word>(a0) * b0 }, p01 { static_cast<Word>(a0) * b1 };
+            const Word p10 { static_cast<Word>(a1) * b0 }, p11 { static_cast<Word>(a1) * b1 };
+            //at most 3 * (2^64 - 1), so cannot overflow
+            const Word middle { (p00 >> 64) + static_cast<uint64_t>(p01) + static_cast<uint64_t>(p10) };
+            high = p11 + (p01 >> 64) + (p10 >> 64) + (middle >> 64);
+            low = (middle << 64) | static_cast<uint64_t>(p00);
+        }
+    }
+
+    //computes t * R^-1 mod n where t == high * R + low
+    //uses the positive inverse variant, which cannot overflow even when n is close to R
+    Word reduce(const Word high, const Word low) const {
+        Word mnHigh, mnLow;
+        mulFull(low * nInv, n, mnHigh, mnLow);
+        return high >= mnHigh ? high - mnHigh : high + (n - mnHigh);
+    }
+
+    //n^-1 mod R via newton's method; (3n) xor 2 is correct to 5 bits, and each iteration doubles the number of correct bits
+    static constexpr Word inverse(const Word n) {
+        if constexpr (wordBits == 64) return FastDivisor::modularInverse(n);
+        else {
+            Word x { (3 * n) ^ 2 };
+            for (unsigned correctBits { 5 }; correctBits < wordBits; correctBits *= 2) x *= 2 - n * x;
+            return x;
+        }
+    }
+
+    static Word rSquaredModN(const Word n) {
+        if constexpr (wordBits < 128) {
+            using Wide = std::conditional_t<wordBits == 32, uint64_t, unsigned __int128>;
+            const Wide rModN { (static_cast<Wide>(1) << wordBits) % n };
+            return static_cast<Word>((rModN * rModN) % n);
+        }
+        //R mod n == (R - n) mod n, which is then doubled mod n once per bit to get R^2 mod n
+        else {
+            Word r { (0 - n) % n };
+            for (unsigned i { 0 }; i < wordBits; ++i) r = r >= n - r ? r - (n - r) : r + r;
+            return r;
+        }
+    }
+
+    const Word nInv, r2;
+};
+
+using Montgomery32 = Montgomery<uint32_t>;
+using Montgomery64 = Montgomery<uint64_t>;
+using Montgomery128 = Montgomery<unsigned __int128>;
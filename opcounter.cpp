@@ -0,0 +1,50 @@
+#include "opcounter.hpp"
+#include <format>
+#include <numeric>
+
+uint64_t OperationCounts::getTotalTicks(void) const {
+    return std::accumulate(stageTicks.begin(), stageTicks.end(), uint64_t { 0 });
+}
+
+OperationCounts& OperationCounts::operator+=(const OperationCounts& other) {
+    trialDivisions += other.trialDivisions;
+    primalityTests += other.primalityTests;
+    modularMultiplications += other.modularMultiplications;
+    for (size_t i { 0 }; i < stageCount; ++i) stageTicks[i] += other.stageTicks[i];
+    return *this;
+}
+
+OperationCounts OperationCounts::operator/(const uint64_t divisor) const {
+    const auto divide = [&](const uint64_t count) { return (count + divisor / 2) / divisor; };
+    OperationCounts quotient { divide(trialDivisions), divide(primalityTests), divide(modularMultiplications) };
+    for (size_t i { 0 }; i < stageCount; ++i) quotient.stageTicks[i] = divide(stageTicks[i]);
+    return quotient;
+}
+
+std::string_view OperationCounts::getStageName(const Stage stage) {
+    switch (stage) {
+    case POWERS_OF_TWO: return "Powers of 2";
+    case SMALL_PRIMES:  return "Small Primes";
+    case TABLE_PRIMES:  return "Table Primes";
+    case BEYOND_TABLE:  return "Beyond Table";
+    case PRIMALITY:     return "Primality";
+    case SPLITTING:     return "Splitting";
+    case OTHER:
+    default:            return "Other";
+    }
+}
+
+std::string formatOperationCounts(const OperationCounts& counts) {
+    return std::format("{} ops ({} divisions, {} test{}, {} mulmods)", counts.getOperationCount(), 
+        counts.trialDivisions, counts.primalityTests, counts.primalityTests == 1 ? "" : "s", counts.modularMultiplications);
+}
+
+#ifdef COUNT_OPERATIONS
+OperationCounts OperationCounter::take(void) {
+    //closes the current stage's interval so far, so that the ticks taken are complete
+    switchStage(state.currentStage);
+    const OperationCounts counts { state.counts };
+    state.counts = {};
+    return counts;
+}
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "tscclock.hpp"
+
+//where the work within a single factorization goes, for telling algorithmic cost apart from timer noise
+struct OperationCounts {
+    //POWERS_OF_TWO strips factors of 2, SMALL_PRIMES is TrialDivisionKernel's scan, TABLE_PRIMES the rest of the prime table,
+    //BEYOND_TABLE trial division past the table's bound, PRIMALITY miller-rabin, SPLITTING every strategy for splitting a cofactor,
+    //and OTHER everything else within primeFactorization (e.g. perfect power detection, sorting the factors found)
+    enum Stage { POWERS_OF_TWO, SMALL_PRIMES, TABLE_PRIMES, BEYOND_TABLE, PRIMALITY, SPLITTING, OTHER, stageCount };
+
+    //divisibility tests by a single prime, whether by the kernel, a FastDivisor or hardware division
+    uint64_t trialDivisions { 0 };
+    //miller-rabin tests, each of which also counts its modular multiplications
+    uint64_t primalityTests { 0 };
+    //montgomery multiplications, including squarings and conversions into montgomery form
+    uint64_t modularMultiplications { 0 };
+    //TSC ticks spent in each stage, excluding time in any stage nested within it
+    std::array<uint64_t, stageCount> stageTicks {};
+
+    //trial divisions plus modular multiplications, which nearly all of the work of every engine consists of
+    uint64_t getOperationCount(void) const { return trialDivisions + modularMultiplications; }
+    uint64_t getTotalTicks(void) const;
+
+    OperationCounts& operator+=(const OperationCounts& other);
+    //each count divided by divisor, rounded to the nearest, e.g. to amortize a batch's counts over its inputs
+    OperationCounts operator/(const uint64_t divisor) const;
+
+    //e.g. "Table Primes"
+    static std::string_view getStageName(const Stage stage);
+};
+
+//e.g. "1234 ops (1000 divisions, 1 test, 234 mulmods)"
+std::string formatOperationCounts(const OperationCounts& counts);
+
+//accumulates the calling thread's OperationCounts as primes::primeFactorization runs
+//counts only in builds with COUNT_OPERATIONS defined; otherwise every member is an empty inline function, and compiles to nothing
+class OperationCounter {
+public:
+    //attributes the ticks from its construction to its destruction to stage, less the ticks of any scope nested within it
+    class StageScope {
+    public:
+        #ifdef COUNT_OPERATIONS
+        explicit StageScope(const OperationCounts::Stage stage) : outerStage(state.currentStage) { switchStage(stage); }
+        ~StageScope() { switchStage(outerStage); }
+        #else
+        explicit StageScope(const OperationCounts::Stage) {}
+        #endif
+
+        StageScope(const StageScope&) = delete;
+        StageScope& operator=(const StageScope&) = delete;
+
+    #ifdef COUNT_OPERATIONS
+    private:
+        const OperationCounts::Stage outerStage;
+    #endif
+    };
+
+    #ifdef COUNT_OPERATIONS
+    static void countTrialDivisions(const uint64_t count = 1) { state.counts.trialDivisions += count; }
+    static void countPrimalityTest(void) { ++state.counts.primalityTests; }
+    static void countModularMultiplication(void) { ++state.counts.modularMultiplications; }
+
+    //the counts since the previous call on this thread, which then start again from 0
+    static OperationCounts take(void);
+    #else
+    static void countTrialDivisions(const uint64_t = 1) {}
+    static void countPrimalityTest(void) {}
+    static void countModularMultiplication(void) {}
+
+    static OperationCounts take(void) { return {}; }
+    #endif
+
+    //whether this build counts operations at all
+    static constexpr bool isEnabled(void) {
+        #ifdef COUNT_OPERATIONS
+        return true;
+        #else
+        return false;
+        #endif
+    }
+
+#ifdef COUNT_OPERATIONS
+private:
+    struct ThreadState {
+        OperationCounts counts;
+        OperationCounts::Stage currentStage { OperationCounts::OTHER };
+        uint64_t stageStart { TscClock::read() };
+    };
+
+    static void switchStage(const OperationCounts::Stage stage) {
+        const uint64_t now { TscClock::read() };
+        state.counts.stageTicks[state.currentStage] += now - state.stageStart;
+        state.currentStage = stage;
+        state.stageStart = now;
+    }
+
+    static thread_local ThreadState state;
+#endif
+};
+
+#ifdef COUNT_OPERATIONS
+inline thread_local OperationCounter::ThreadState OperationCounter::state;
+#endif
@@ -0,0 +1,117 @@
+#include "perfcounters.hpp"
+#include <cerrno>
+#include <cstring>
+#include <format>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+HardwareCounts& HardwareCounts::operator+=(const HardwareCounts& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    branchMisses += other.branchMisses;
+    cacheMisses += other.cacheMisses;
+    return *this;
+}
+
+HardwareCounts HardwareCounts::operator-(const HardwareCounts& other) const {
+    return { cycles - other.cycles, instructions - other.instructions, branchMisses - other.branchMisses, cacheMisses - other.cacheMisses };
+}
+
+HardwareCounts HardwareCounts::operator/(const uint64_t divisor) const {
+    const auto divide = [&](const uint64_t count) { return (count + divisor / 2) / divisor; };
+    return { divide(cycles), divide(instructions), divide(branchMisses), divide(cacheMisses) };
+}
+
+std::string formatHardwareCounts(const HardwareCounts& counts, const uint64_t inputCount) {
+    const auto perInput = [&](const PerfCounters::Event event, const uint64_t count) {
+        return PerfCounters::isEventAvailable(event) ? std::format("{:.1f}", static_cast<long double>(count) / inputCount) : std::string("n/a");
+    };
+    return std::format("IPC {}, {} branch misses, {} cache misses",
+        PerfCounters::isEventAvailable(PerfCounters::INSTRUCTIONS) && counts.cycles ? std::format("{:.2f}", static_cast<long double>(counts.instructions) / counts.cycles) : "n/a",
+        perInput(PerfCounters::BRANCH_MISSES, counts.branchMisses), perInput(PerfCounters::CACHE_MISSES, counts.cacheMisses));
+}
+
+#ifdef __linux__
+//perf_event_attr config of each Event, in order
+static constexpr uint64_t eventConfigs[PerfCounters::eventCount] {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+};
+
+//counts the event for the calling thread in user space only, which perf_event_paranoid permits up to level 2
+static int openEvent(const uint64_t config, const int groupFd) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = config;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupFd, 0));
+}
+#endif
+
+PerfCounters::PerfCounters(void) {
+    fds.fill(-1);
+    readIndices.fill(-1);
+    #ifdef __linux__
+    if ((groupFd = openEvent(eventConfigs[CYCLES], -1)) == -1) return;
+    fds[CYCLES] = groupFd;
+    readIndices[CYCLES] = openCount++;
+    for (int event { CYCLES + 1 }; event < eventCount; ++event)
+        if ((fds[event] = openEvent(eventConfigs[event], groupFd)) != -1) readIndices[event] = openCount++;
+    #endif
+}
+
+PerfCounters::~PerfCounters() {
+    #ifdef __linux__
+    for (const int fd : fds) if (fd != -1) close(fd);
+    #endif
+}
+
+PerfCounters& PerfCounters::forThisThread(void) {
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+HardwareCounts PerfCounters::read(void) const {
+    HardwareCounts counts;
+    #ifdef __linux__
+    if (groupFd == -1) return counts;
+    //{ number of events, value of each event in the order opened }
+    uint64_t values[1 + eventCount];
+    if (::read(groupFd, values, sizeof(uint64_t) * (1 + openCount)) <= 0) return counts;
+    const auto valueOf = [&](const Event event) { return readIndices[event] == -1 ? 0 : values[1 + readIndices[event]]; };
+    counts = { valueOf(CYCLES), valueOf(INSTRUCTIONS), valueOf(BRANCH_MISSES), valueOf(CACHE_MISSES) };
+    #endif
+    return counts;
+}
+
+std::string PerfCounters::probe(void) {
+    availableEvents.fill(false);
+    #ifdef __linux__
+    const int cyclesFd { openEvent(eventConfigs[CYCLES], -1) };
+    if (cyclesFd == -1) {
+        //ENOENT and EOPNOTSUPP come from a kernel or hypervisor without the event, EACCES and EPERM from perf_event_paranoid or a sandbox
+        return errno == ENOENT || errno == EOPNOTSUPP ? std::format("no hardware cycle counter available ({})", std::strerror(errno))
+            : std::format("perf_event_open not permitted ({}); see /proc/sys/kernel/perf_event_paranoid", std::strerror(errno));
+    }
+    availableEvents[CYCLES] = true;
+    for (int event { CYCLES + 1 }; event < eventCount; ++event) {
+        const int fd { openEvent(eventConfigs[event], cyclesFd) };
+        availableEvents[event] = fd != -1;
+        if (fd != -1) close(fd);
+    }
+    close(cyclesFd);
+    return "";
+    #else
+    return "perf_event_open is only available on Linux";
+    #endif
+}
+
+bool PerfCounters::isEventAvailable(const Event event) {
+    return availableEvents[event];
+}
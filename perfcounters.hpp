@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+//counts of hardware events over some interval, or summed over several
+struct HardwareCounts {
+    uint64_t cycles { 0 }, instructions { 0 }, branchMisses { 0 }, cacheMisses { 0 };
+
+    HardwareCounts& operator+=(const HardwareCounts& other);
+    HardwareCounts operator-(const HardwareCounts& other) const;
+    //each count divided by divisor, rounded to the nearest, e.g. to amortize a block's counts over its inputs
+    HardwareCounts operator/(const uint64_t divisor) const;
+
+    //false for inputs that were never counted, as any interval counted takes at least a cycle
+    bool isCounted(void) const { return cycles; }
+};
+
+//e.g. "IPC 2.41, 3.2 branch misses, 0.1 cache misses", with counts divided by inputCount
+//events that could not be opened are shown as n/a
+std::string formatHardwareCounts(const HardwareCounts& counts, const uint64_t inputCount = 1);
+
+//user space hardware event counters for the calling thread, opened through perf_event_open as one group so that they are read together
+//where perf events are not permitted (e.g. perf_event_paranoid, seccomp) or no PMU is exposed (e.g. many VMs), nothing is opened and reads are all 0
+class PerfCounters {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, BRANCH_MISSES, CACHE_MISSES, eventCount };
+
+    //the calling thread's counters, opened on its first call
+    static PerfCounters& forThisThread(void);
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    //totals since the counters were opened, in a single read system call (hundreds of ns, so best kept outside of timed intervals)
+    HardwareCounts read(void) const;
+
+    //opens counters on the calling thread to find which events are permitted, returning an empty string if cycles are, or the reason if not
+    //every event besides cycles is optional, and reads as 0 if it could not be opened
+    static std::string probe(void);
+    //as found by the last probe
+    static bool isEventAvailable(const Event event);
+
+private:
+    PerfCounters(void);
+
+    //the cycles counter, which leads the group; -1 if it could not be opened, in which case no other event is either
+    int groupFd { -1 };
+    std::array<int, eventCount> fds;
+    //index of each event's value within a group read, or -1 if the event is not open
+    std::array<int, eventCount> readIndices;
+    int openCount { 0 };
+
+    static inline std::array<bool, eventCount> availableEvents {};
+};
@@ -1,76 +1,474 @@
 #include "primes.hpp"
+#include "opcounter.hpp"
+#include "tieredfactorization.hpp"
 
-Factorization primes::primeFactorization(uint64_t n) {
-    Factorization foundFactors;
+#include <bit>
+
+//bits in Word
+template<class Word>
+static constexpr unsigned wordBits = sizeof(Word) * 8;
+
+template<class Word>
+static unsigned countTrailingZeros(const Word n) {
+    if constexpr (wordBits<Word> <= 64) return std::countr_zero(n);
+    else return static_cast<uint64_t>(n) ? std::countr_zero(static_cast<uint64_t>(n)) : 64 + std::countr_zero(static_cast<uint64_t>(n >> 64));
+}
+
+static int countLeadingZeros(const unsigned __int128 n) {
+    return n >> 64 ? std::countl_zero(static_cast<uint64_t>(n >> 64)) : 64 + std::countl_zero(static_cast<uint64_t>(n));
+}
+
+//binary gcd for 128 bit n, which std::gcd does not portably support
+template<class Word>
+static Word greatestCommonDivisor(Word a, Word b) {
+    if constexpr (wordBits<Word> <= 64) return std::gcd(a, b);
+    else {
+        if (!a || !b) return a | b;
+        const unsigned shift { countTrailingZeros(a | b) };
+        a >>= countTrailingZeros(a);
+        do {
+            b >>= countTrailingZeros(b);
+            if (a > b) std::swap(a, b);
+            b -= a;
+        } while (b);
+        return a << shift;
+    }
+}
+
+//primality test and splitting at the narrowest width n fits in, as narrower montgomery arithmetic is cheaper
+template<class Word>
+static bool isPrimeAtNarrowestWidth(const Word n) {
+    if constexpr (wordBits<Word> > 32) if (n <= std::numeric_limits<uint32_t>::max()) return primes::isPrimeMillerRabin(static_cast<uint32_t>(n));
+    if constexpr (wordBits<Word> > 64) if (n <= std::numeric_limits<uint64_t>::max()) return primes::isPrimeMillerRabin(static_cast<uint64_t>(n));
+    return primes::isPrimeMillerRabin(n);
+}
+
+template<class Word>
+static Word pollardBrentAtNarrowestWidth(const Word n) {
+    if constexpr (wordBits<Word> > 32) if (n <= std::numeric_limits<uint32_t>::max()) return primes::pollardBrent(static_cast<uint32_t>(n));
+    if constexpr (wordBits<Word> > 64) if (n <= std::numeric_limits<uint64_t>::max()) return primes::pollardBrent(static_cast<uint64_t>(n));
+    return primes::pollardBrent(n);
+}
+
+//divides out of n every odd prime factor below limit, returning a floor below which n has no remaining odd prime factors
+//precondition: n is odd or 0, limit <= TrialDivisionKernel::kernelBound unless Word is uint64_t
+template<class Word>
+static uint64_t divideOutSmallPrimes(Word& n, BasicFactorization<Word>& foundFactors, const uint64_t limit) {
+    if constexpr (wordBits<Word> == 64) return primes::divideOutTablePrimes(n, foundFactors, limit);
+    else if constexpr (wordBits<Word> == 32) {
+        uint64_t maxLessorDivisor { std::min(primes::isqrt(n), limit - 1) };
+        const TrialDivisionKernel32& kernel { TrialDivisionKernel32::get() };
+        for (size_t i { kernel.findDivisor(n, 0, maxLessorDivisor) }; i < kernel.getPrimeCount(); i = kernel.findDivisor(n, i + 1, maxLessorDivisor)) {
+            uint_fast8_t exp { 0 };
+            for (; kernel.divides(n, i); ++exp) n = kernel.divideExact(n, i);
+            foundFactors.addNewFactor(kernel.getPrime(i), exp);
+            maxLessorDivisor = std::min(primes::isqrt(n), limit - 1);
+        }
+        return maxLessorDivisor + 1;
+    }
+    //no kernel covers 128 bit n, but only the few primes below the rho engine's bound are ever tested at this width
+    else {
+        const OperationCounter::StageScope stage(OperationCounts::SMALL_PRIMES);
+        const TrialDivisionKernel& kernel { TrialDivisionKernel::get() };
+        size_t i { 0 };
+        for (; i < kernel.getPrimeCount() && kernel.getPrime(i) < limit; ++i) {
+            OperationCounter::countTrialDivisions();
+            const uint64_t p { kernel.getPrime(i) };
+            uint_fast8_t exp { 0 };
+            for (; n && n % p == 0; ++exp) n /= p;
+            if (exp) foundFactors.addNewFactor(p, exp);
+        }
+        return i < kernel.getPrimeCount() ? kernel.getPrime(i) : TrialDivisionKernel::kernelBound;
+    }
+}
+
+//factors n by repeatedly looking up its least prime factor, so inputs this small need no trial division at all
+//precondition: n < smallFastDivisorBound
+static Factorization32 smallestFactorFactorization(uint32_t n) {
+    Factorization32 foundFactors;
+    if (n < 2u) return foundFactors;
+    if (const unsigned exp { countTrailingZeros(n) }) {
+        const OperationCounter::StageScope stage(OperationCounts::POWERS_OF_TWO);
+        n >>= exp;
+        foundFactors.addNewFactor(2, exp);
+    }
+
+    const OperationCounter::StageScope stage(OperationCounts::SMALL_PRIMES);
+    //factors are found in ascending order, so each run of equal factors is one prime's exponent
+    uint32_t p { 0 };
+    uint_fast8_t exp { 0 };
+    while (n > 1u) {
+        const uint32_t factor { primes::smallestOddFactors[n / 2] ? primes::smallestOddFactors[n / 2] : n };
+        if (factor != p) {
+            if (exp) foundFactors.addNewFactor(p, exp);
+            p = factor;
+            exp = 0;
+        }
+        n /= factor;
+        ++exp;
+    }
+    if (exp) foundFactors.addNewFactor(p, exp);
+    return foundFactors;
+}
+
+template<class Word>
+BasicFactorization<Word> primes::primeFactorization(Word n, const Engine engine) {
+    //every engine gives the same factorization, and none is faster than a table lookup
+    if (n < smallFastDivisorBound) return BasicFactorization<Word>(smallestFactorFactorization(static_cast<uint32_t>(n)));
+    //the tiered engine only uses trial division below 64 bits, so n past its crossover stays at 64 bits to reach the other tiers
+    if constexpr (wordBits<Word> > 32) {
+        if (n <= std::numeric_limits<uint32_t>::max() && 
+            (engine != Engine::TIERED || static_cast<unsigned>(std::bit_width(static_cast<uint32_t>(n))) <= getTierCrossovers().trialDivisionMaxBits))
+            return BasicFactorization<Word>(primeFactorization(static_cast<uint32_t>(n), engine));
+    }
+    if constexpr (wordBits<Word> > 64) {
+        if (n <= std::numeric_limits<uint64_t>::max()) return BasicFactorization<Word>(primeFactorization(static_cast<uint64_t>(n), engine));
+        return pollardRhoFactorization(n);
+    }
+    else {
+        switch (engine) {
+        case Engine::POLLARD_RHO:
+            return pollardRhoFactorization(n);
+        case Engine::TIERED:
+            if constexpr (wordBits<Word> == 32) {
+                if (static_cast<unsigned>(std::bit_width(n)) <= getTierCrossovers().trialDivisionMaxBits) return trialDivisionFactorization(n);
+                return BasicFactorization<Word>(tieredFactorization(n));
+            }
+            else return tieredFactorization(n);
+        case Engine::TRIAL_DIVISION:
+        default:
+            return trialDivisionFactorization(n);
+        }
+    }
+}
+
+template<class Word>
+BasicFactorization<Word> primes::trialDivisionFactorization(Word n) {
+    static_assert(wordBits<Word> <= 64, "trial division through sqrt(n) is impractical beyond 64 bits");
+    BasicFactorization<Word> foundFactors;
     //counts powers of discovered prime factors
-    //doubles as an flag of n's value being lowered since previous isPrime(n...) check, which results from said powers being factored out
     uint_fast8_t exp { 0 };
     //special case for multiples of nontrivial powers of 2
     //simplifies skipping evens for the rest of this instance of the function 
     if (n > 1ull) {
+        const OperationCounter::StageScope stage(OperationCounts::POWERS_OF_TWO);
         for (; !(n & 0b1); ++exp) n >>= 1;
         if (exp) foundFactors.addNewFactor(2, exp);
     }
-    //set to 1 to catch when n is already prime 
-    exp = 1;
-    //divides n by all odd primes until reaching the value of each of n's prime factors,
-    //possibly excluding the greatest prime factor iff the square of said factor does not divide n
-    uint64_t divisor { 1 };
-    while (n > 1ull) {
-        if (exp) { //only need to recheck if n has changed since last check 
-            //n % k where 0 < k < divisor is already checked and can be skipped here, hence passing divisor as factor floor
-            if (isPrime(n, divisor)) { 
-                //no n^k where integer k != 1 is prime, therefore k == 1
-                foundFactors.addNewFactor(n, 1);
-                break; //n must be the largest prime factor at this point, therefore the loop may now be exited
-            } 
-            exp = 0; //exp no longer needs to act as a flag this iteration, resets to 0
+
+    //the 32 bit kernel covers every prime through sqrt(n)
+    if constexpr (wordBits<Word> == 32) {
+        divideOutSmallPrimes(n, foundFactors, std::numeric_limits<uint64_t>::max());
+        if (n > 1u) foundFactors.addNewFactor(n, 1);
+        return foundFactors;
+    }
+    else {
+        //continues past the table's bound if n may still have a factor there
+        divideOutWheelCandidates(n, foundFactors, divideOutTablePrimes(n, foundFactors, std::numeric_limits<uint64_t>::max()));
+        //no divisor <= sqrt(n) remains, so n is either 1 or its own greatest prime factor
+        if (n > 1ull) foundFactors.addNewFactor(n, 1);
+        return foundFactors;
+    }
+}
+
+template<size_t wheelBasisSize>
+uint64_t primes::divideOutWheelCandidates(uint64_t& n, Factorization& foundFactors, const uint64_t floor) {
+    Wheel<wheelBasisSize> wheel(floor);
+    uint64_t maxLessorDivisor { isqrt(n) };
+    if (wheel.get() > maxLessorDivisor) return wheel.get();
+
+    //composite candidates can never divide n here, as their prime factors have already been divided out,
+    //so the wheel is stepped through rather than testing each candidate for primality
+    const OperationCounter::StageScope stage(OperationCounts::BEYOND_TABLE);
+    //each candidate is tried once, so hardware division beats building a FastDivisor inverse for it
+    for (; wheel.get() <= maxLessorDivisor; wheel.advance()) {
+        OperationCounter::countTrialDivisions();
+        if (n % wheel.get()) continue;
+
+        uint_fast8_t exp { 0 };
+        for (; n % wheel.get() == 0; ++exp) n /= wheel.get();
+        foundFactors.addNewFactor(wheel.get(), exp);
+        maxLessorDivisor = isqrt(n);
+    }
+    return wheel.get();
+}
+
+uint64_t primes::divideOutTablePrimes(uint64_t& n, Factorization& foundFactors, const uint64_t limit) {
+    //once divisor exceeds sqrt(n), n can have no remaining factor other than itself
+    //the bound is lowered each time a factor is divided out of n
+    uint64_t maxLessorDivisor { std::min(isqrt(n), limit - 1) };
+
+    //small factor stage, covering the primes most likely to divide n without any hardware division
+    const TrialDivisionKernel& kernel { TrialDivisionKernel::get() };
+    for (size_t i { kernel.findDivisor(n, 0, maxLessorDivisor) }; i < kernel.getPrimeCount(); i = kernel.findDivisor(n, i + 1, maxLessorDivisor)) {
+        uint_fast8_t exp { 0 };
+        for (; kernel.divides(n, i); ++exp) n = kernel.divideExact(n, i);
+        foundFactors.addNewFactor(kernel.getPrime(i), exp);
+        maxLessorDivisor = std::min(isqrt(n), limit - 1);
+    }
+    if (maxLessorDivisor < TrialDivisionKernel::kernelBound) return maxLessorDivisor + 1;
+
+    //continues through the rest of the table where the kernel left off
+    const OperationCounter::StageScope stage(OperationCounts::TABLE_PRIMES);
+    uint64_t divisor { kernel.getPrime(kernel.getPrimeCount() - 1) };
+    const PrimeTable& table { getPrimeTable() };
+    const std::span<const uint8_t> halfGaps { table.viewHalfGaps() };
+    for (size_t i { kernel.getPrimeCount() }; i < halfGaps.size(); ) {
+        //the table caches each prime's inverse, so testing a divisor costs a multiplication or two rather than a division
+        const size_t chunkFirst { i - i % PrimeTable::inverseChunkSize };
+        const std::span<const uint64_t> inverses { table.viewInverses(i / PrimeTable::inverseChunkSize) };
+        for (; i < chunkFirst + inverses.size(); ++i) {
+            divisor += 2u * halfGaps[i];
+            if (divisor > maxLessorDivisor) return divisor;
+            OperationCounter::countTrialDivisions();
+            const FastDivisor fastDivisor(divisor, inverses[i - chunkFirst]);
+            if (!fastDivisor.divides(n)) continue;
+
+            uint_fast8_t exp { 0 };
+            for (; fastDivisor.divides(n); ++exp) n = fastDivisor.divideExact(n);
+            foundFactors.addNewFactor(divisor, exp);
+            maxLessorDivisor = std::min(isqrt(n), limit - 1);
         }
-        //only relevant factors are primes
-        //note that divisor is always incremented at least once
-        while (!isPrime(divisor += 2u));
+    }
+    //every prime in the table has been tested
+    return std::max(divisor + 2u, table.getBound() | 1u);
+}
+
+uint64_t primes::isqrt(const uint64_t n) {
+    //the double approximation may be off by one in either direction for large n
+    uint64_t root { static_cast<uint64_t>(std::sqrt(static_cast<double>(n))) };
+    if (root > std::numeric_limits<uint32_t>::max()) root = std::numeric_limits<uint32_t>::max();
+    while (root * root > n) --root;
+    while (root < std::numeric_limits<uint32_t>::max() && (root + 1) * (root + 1) <= n) ++root;
+    return root;
+}
+
+static std::optional<PrimeTable> primeTable;
 
-        for (; n % divisor == 0; ++exp) n /= divisor;
-        if (exp) foundFactors.addNewFactor(divisor, exp);
+void primes::loadPrimeTable(const uint64_t bound, const std::string& cachePath) {
+    primeTable.reset();
+    primeTable.emplace(std::max(bound, minPrimeTableBound), cachePath);
+}
+
+const PrimeTable& primes::getPrimeTable(void) {
+    if (!primeTable) loadPrimeTable(defaultPrimeTableBound);
+    return *primeTable;
+}
+
+template<class Word>
+BasicFactorization<Word> primes::pollardRhoFactorization(Word n) {
+    BasicFactorization<Word> foundFactors;
+    //0 and 1 have no prime factorization
+    if (n < 2u) return foundFactors;
+
+    //strips powers of 2 to guarantee the odd modulus montgomery form requires
+    if (const unsigned exp { countTrailingZeros(n) }) {
+        const OperationCounter::StageScope stage(OperationCounts::POWERS_OF_TWO);
+        n >>= exp;
+        foundFactors.addNewFactor(2, exp);
+    }
+    //short trial division pass removes small factors, which are cheaper to find this way than via rho
+    const uint64_t factorFloor { divideOutSmallPrimes(n, foundFactors, pollardRhoTrialBound) };
+    if (n == 1u) return foundFactors;
+    //n has no factors below factorFloor, so it must be prime if it is below factorFloor's square
+    if (static_cast<Word>(factorFloor) * factorFloor > n) {
+        foundFactors.addNewFactor(n, 1);
+        return foundFactors;
+    }
+
+    //all remaining factors are >= pollardRhoTrialBound == 2^8, so there can be no more than one per byte of Word
+    std::array<Word, sizeof(Word)> foundPrimes;
+    std::array<Word, sizeof(Word)> unsplit { n };
+    size_t foundCount { 0 }, unsplitCount { 1 };
+    while (unsplitCount) {
+        const Word m { unsplit[--unsplitCount] };
+        if (isPrimeAtNarrowestWidth(m)) foundPrimes[foundCount++] = m;
+        else {
+            const Word d { pollardBrentAtNarrowestWidth(m) };
+            unsplit[unsplitCount++] = d;
+            unsplit[unsplitCount++] = m / d;
+        }
+    }
+
+    //rho finds factors in no particular order, so they are sorted to match the ascending output of trial division
+    //insertion sort, as there are at most 16 elements
+    for (size_t i { 1 }; i < foundCount; ++i)
+        for (size_t j { i }; j && foundPrimes[j - 1] > foundPrimes[j]; --j) std::swap(foundPrimes[j - 1], foundPrimes[j]);
+    for (size_t i { 0 }, j; i < foundCount; i = j) {
+        for (j = i + 1; j < foundCount && foundPrimes[j] == foundPrimes[i]; ++j);
+        foundFactors.addNewFactor(foundPrimes[i], j - i);
     }
     return foundFactors;
 }
 
-inline bool primes::isPrime(const uint64_t n) {
-    return isPrime(n, 5);
+//jacobi symbol (a/n), which is -1, 0 or 1
+//precondition: n is odd
+template<class Word>
+static int jacobiSymbol(Word a, Word n) {
+    int result { 1 };
+    a %= n;
+    while (a) {
+        //(2/n) is -1 exactly when n is 3 or 5 mod 8
+        for (; !(a & 0b1); a >>= 1) if ((n & 0b111) == 3u || (n & 0b111) == 5u) result = -result;
+        //quadratic reciprocity, as both are now odd
+        std::swap(a, n);
+        if ((a & 0b11) == 3u && (n & 0b11) == 3u) result = -result;
+        a %= n;
+    }
+    return n == 1u ? result : 0;
 }
 
-inline bool primes::isPrime(const uint64_t n, const uint64_t potentialFactorFloor) {
-    //this switch is slightly faster than any obvious bitwise approaches tested so far, which all need to first check (n < 4)
-    switch (n) {
-        case 0ul: 
-        case 1ul: return false;
-        case 2ul: 
-        case 3ul: return true;
+//greatest integer <= sqrt(n) by newton's method, starting from a power of 2 above it so that every step descends
+static unsigned __int128 isqrt128(const unsigned __int128 n) {
+    if (n < 2u) return n;
+    unsigned __int128 x { static_cast<unsigned __int128>(1) << ((128 - countLeadingZeros(n) + 1) / 2) };
+    for (unsigned __int128 y { (x + n / x) >> 1 }; y < x; y = (x + n / x) >> 1) x = y;
+    return x;
+}
+
+//strong lucas probable prime test with selfridge's parameters: the first D of 5, -7, 9, -11, ... with (D/n) == -1, P == 1 and Q == (1 - D) / 4
+//together with a strong base 2 test this is the baillie-psw test, which has no known counterexample
+//precondition: n is odd, at least 2^64, and not a square
+static bool isStrongLucasProbablePrime(const unsigned __int128 n) {
+    int64_t D { 5 };
+    for (;; D = D > 0 ? -(D + 2) : -D + 2) {
+        const unsigned __int128 magnitude { static_cast<unsigned __int128>(D > 0 ? D : -D) };
+        const int jacobi { jacobiSymbol(D > 0 ? magnitude : n - magnitude % n, n) };
+        if (jacobi == -1) break;
+        //n shares a factor with D, and n exceeds D, so is composite
+        if (jacobi == 0) return false;
+    }
+
+    const Montgomery128 mont(n);
+    const auto toMontSigned = [&](const int64_t a) {
+        const unsigned __int128 magnitude { mont.toMont(static_cast<unsigned __int128>(a > 0 ? a : -a)) };
+        return a >= 0 ? magnitude : mont.sub(0, magnitude);
+    };
+    //x / 2 mod n, which is also x / 2 in montgomery form
+    const auto half = [&](const unsigned __int128 x) { return x & 0b1 ? (x >> 1) + (n >> 1) + 1 : x >> 1; };
+    const unsigned __int128 montD { toMontSigned(D) }, montQ { toMontSigned((1 - D) / 4) };
+
+    //n + 1 == d * 2^s where d is odd; n + 1 cannot overflow, as 2^128 - 1 is divisible by 3 and so fails the base 2 test first
+    const unsigned s { countTrailingZeros(static_cast<unsigned __int128>(n + 1)) };
+    const unsigned __int128 d { (n + 1) >> s };
+
+    //U_k, V_k and Q^k, from k == 1 through k == d by doubling and incrementing k along the bits of d from the top
+    unsigned __int128 u { mont.toMont(1) }, v { u }, qk { montQ };
+    for (int bit { 126 - countLeadingZeros(d) }; bit >= 0; --bit) {
+        //U_2k == U_k * V_k, V_2k == V_k^2 - 2Q^k
+        u = mont.mul(u, v);
+        v = mont.sub(mont.mul(v, v), mont.add(qk, qk));
+        qk = mont.mul(qk, qk);
+        if ((d >> bit) & 0b1) {
+            //U_k+1 == (U_k + V_k) / 2, V_k+1 == (D * U_k + V_k) / 2
+            const unsigned __int128 nextU { half(mont.add(u, v)) };
+            v = half(mont.add(mont.mul(montD, u), v));
+            u = nextU;
+            qk = mont.mul(qk, montQ);
+        }
+    }
+    if (!u || !v) return true;
+    //V_d * 2^r for r from 1 through s - 1
+    for (unsigned r { 1 }; r < s; ++r) {
+        v = mont.sub(mont.mul(v, v), mont.add(qk, qk));
+        if (!v) return true;
+        qk = mont.mul(qk, qk);
     }
+    return false;
+}
+
+template<class Word>
+bool primes::isPrimeMillerRabin(const Word n) {
+    if (n < 4u) return n > 1u;
+    if (!(n & 0b1)) return false;
+    //the 64 bit bases are deterministic, so are preferred to baillie-psw wherever n fits
+    if constexpr (wordBits<Word> > 64) if (n <= std::numeric_limits<uint64_t>::max()) return isPrimeMillerRabin(static_cast<uint64_t>(n));
+    const OperationCounter::StageScope stage(OperationCounts::PRIMALITY);
+    OperationCounter::countPrimalityTest();
 
-    //handles these two cases separately to allow optimizations in the loop below
-    if (n % 2ul == 0ull || n % 3ul == 0ul) return false;
+    std::span<const uint64_t> bases;
+    if constexpr (wordBits<Word> == 32) bases = millerRabinBases32;
+    else if constexpr (wordBits<Word> == 64) bases = millerRabinBases64;
+    else bases = millerRabinBases128;
 
-    //greatest integer <= the sqrt of n, truncation ok
-    const uint32_t maxLessorDivisor { static_cast<uint32_t>(sqrt(n)) };
+    const Montgomery<Word> mont(n);
+    const Word one { mont.toMont(1) }, minusOne { mont.toMont(n - 1) };
+    //n - 1 == d * 2^s where d is odd
+    const unsigned s { countTrailingZeros(static_cast<Word>(n - 1)) };
+    const Word d { (n - 1) >> s };
 
-    //iterates through all odd numbers from at least 5 through the greatest odd int <= n's sqrt inclusive
-    for (uint64_t i { std::max(potentialFactorFloor, 5ul) }; i <= maxLessorDivisor; i += 2ul) {
-        //skip multiples of 3 (very common case); severely diminishing returns for numbers beyond this
-        //additionally checking for 5 heuristically appears to slow runtime on average by ~1.25x, whereas the case with no such skips at all is ~1.5x
-        if (i % 3ul == 0) i += 2ul;
-        //if n is divisible by any of these values, n is not prime
-        if (n % i == 0) return false;
+    for (const uint64_t base : bases) {
+        //a base that is a multiple of n says nothing about n's primality
+        if (base % n == 0) continue;
+        Word x { mont.pow(mont.toMont(base), d) };
+        if (x == one || x == minusOne) continue;
+        unsigned i { 1 };
+        for (; i < s; ++i) {
+            x = mont.mul(x, x);
+            if (x == minusOne) break;
+        }
+        if (i == s) return false;
+    }
+    //a square is never a strong lucas probable prime, but would leave no D with (D/n) == -1 to find
+    if constexpr (wordBits<Word> > 64) {
+        const Word root { isqrt128(n) };
+        return root * root != n && isStrongLucasProbablePrime(n);
     }
     return true;
 }
 
-std::unordered_set<uint32_t> primes::populatePrimeSet() {
-    std::unordered_set<uint32_t> primeSet;
-    //use no more than half the total available memory
-    for (uint32_t i = 2; primeSet.size() < primeSet.max_size() / 2; ++i) 
-        if (isPrime(i)) primeSet.insert(2);
-    
-    return primeSet;
+template<class Word>
+Word primes::pollardBrent(const Word n) {
+    //number of steps whose differences are multiplied together before taking a single gcd
+    static constexpr uint64_t gcdBatchSize = 128;
+    const OperationCounter::StageScope stage(OperationCounts::SPLITTING);
+
+    const Montgomery<Word> mont(n);
+    //f(y) = y^2 + c; retried with a new c in the rare event that a cycle is found mod n rather than mod a factor
+    for (Word c { mont.toMont(1) }; ; c = mont.add(c, mont.toMont(1))) {
+        const auto f = [&](const Word y){ return mont.add(mont.mul(y, y), c); };
+        Word x, y { mont.toMont(2) }, ys, q { mont.toMont(1) }, g { 1 };
+
+        for (uint64_t r { 1 }; g == 1u; r <<= 1) {
+            x = y;
+            for (uint64_t i { 0 }; i < r; ++i) y = f(y);
+            for (uint64_t k { 0 }; k < r && g == 1u; k += gcdBatchSize) {
+                ys = y;
+                for (uint64_t i { 0 }; i < std::min(gcdBatchSize, r - k); ++i) {
+                    y = f(y);
+                    q = mont.mul(q, x > y ? x - y : y - x);
+                }
+                //montgomery form multiplies by R, which is coprime to n, so the gcd is unaffected
+                g = greatestCommonDivisor(q, n);
+            }
+        }
+        //the batch overshot, so the steps of the last batch are retraced one gcd at a time
+        if (g == n) {
+            do {
+                ys = f(ys);
+                g = greatestCommonDivisor(x > ys ? x - ys : ys - x, n);
+            } while (g == 1u);
+        }
+        if (g != n) return g;
+    }
 }
+
+template Factorization32 primes::primeFactorization(uint32_t, const Engine);
+template Factorization primes::primeFactorization(uint64_t, const Engine);
+template Factorization128 primes::primeFactorization(unsigned __int128, const Engine);
+template Factorization32 primes::trialDivisionFactorization(uint32_t);
+template Factorization primes::trialDivisionFactorization(uint64_t);
+template Factorization32 primes::pollardRhoFactorization(uint32_t);
+template Factorization primes::pollardRhoFactorization(uint64_t);
+template Factorization128 primes::pollardRhoFactorization(unsigned __int128);
+template uint64_t primes::divideOutWheelCandidates<1>(uint64_t&, Factorization&, const uint64_t);
+template uint64_t primes::divideOutWheelCandidates<2>(uint64_t&, Factorization&, const uint64_t);
+template uint64_t primes::divideOutWheelCandidates<3>(uint64_t&, Factorization&, const uint64_t);
+template uint64_t primes::divideOutWheelCandidates<4>(uint64_t&, Factorization&, const uint64_t);
+template uint64_t primes::divideOutWheelCandidates<5>(uint64_t&, Factorization&, const uint64_t);
+template bool primes::isPrimeMillerRabin(const uint32_t);
+template bool primes::isPrimeMillerRabin(const uint64_t);
+template bool primes::isPrimeMillerRabin(const unsigned __int128);
+template uint32_t primes::pollardBrent(const uint32_t);
+template uint64_t primes::pollardBrent(const uint64_t);
+template unsigned __int128 primes::pollardBrent(const unsigned __int128);
@@ -1,20 +1,82 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <numeric>
 #include <cstdint>
-#include <unordered_set>
+#include <limits>
+#include <optional>
+#include <string>
 #include "factorization.hpp"
+#include "montgomery.hpp"
+#include "primetable.hpp"
+#include "trialkernel.hpp"
+#include "wheel.hpp"
 
-//notes: isPrime(uint64_t, uint64_t) possibly use uint32_t for i? careful about overflow
+static constexpr int engineCount = 3;
 
 namespace primes {
+    enum class Engine {
+        TRIAL_DIVISION, //trial division by primes through the prime table, then by candidates on a wheel through sqrt(n)
+        POLLARD_RHO,    //small trial division pass, then miller-rabin for primality and pollard-brent rho for splitting
+        TIERED          //small trial division pass and perfect power detection, then a splitting strategy chosen by bit width; see tieredFactorization
+    };
+
     //returns a map of prime factors of n and their respective powers in the form key == base, val == power
-    Factorization primeFactorization(uint64_t n);
+    //Word is uint32_t, uint64_t or unsigned __int128, and n is factored with the narrowest of these widths that fits it,
+    //so a 64 bit n below 2^32 is factored entirely with 32 bit arithmetic, and a 128 bit n below 2^64 with 64 bit arithmetic
+    //trial division through sqrt(n) is impractical beyond 64 bits, so every engine falls back on rho for such n
+    template<class Word>
+    BasicFactorization<Word> primeFactorization(Word n, const Engine engine = Engine::TRIAL_DIVISION);
+
+    //the following operate at Word's width only, without dispatching to a narrower one
+    //trial division is available for uint32_t and uint64_t, the rest for all three widths
+
+    template<class Word> BasicFactorization<Word> trialDivisionFactorization(Word n);
+    template<class Word> BasicFactorization<Word> pollardRhoFactorization(Word n);
+
+    //wheels by number of basis primes; see Wheel
+    //the mod 2310 wheel tries 21% of integers, against 33% for the mod 6 wheel and 23% for mod 210, and measured fastest in the wheel benchmark
+    static constexpr size_t defaultWheelBasisSize = 5;
+
+    //deterministic for all n through 64 bits
+    //beyond 64 bits, the baillie-psw test (a strong base 2 test then a strong lucas test), for which no counterexample is known
+    template<class Word> bool isPrimeMillerRabin(const Word n);
+
+    //returns a nontrivial factor of n
+    //precondition: n is odd, composite, and not a perfect power of a prime below pollardRhoTrialBound
+    template<class Word> Word pollardBrent(const Word n);
+
+    //divides out of n every odd prime factor below limit, starting with the primes covered by TrialDivisionKernel, 
+    //then walking the rest of the prime table in ascending order
+    //stops early once the divisor passes sqrt(n), as n can then have no remaining factor other than itself
+    //returns a floor below which n is guaranteed to have no remaining odd prime factors
+    //precondition: n is odd or 0
+    uint64_t divideOutTablePrimes(uint64_t& n, Factorization& foundFactors, const uint64_t limit);
+
+    //divides out of n every prime factor from floor through sqrt(n), trying each candidate divisor on a wheel of wheelBasisSize primes
+    //returns a floor below which n is guaranteed to have no remaining prime factors, so n is 1 or prime afterwards
+    //precondition: n has no prime factors below floor, and floor exceeds every prime in the wheel's basis
+    template<size_t wheelBasisSize = defaultWheelBasisSize> uint64_t divideOutWheelCandidates(uint64_t& n, Factorization& foundFactors, const uint64_t floor);
+
+    //greatest integer <= sqrt(n)
+    uint64_t isqrt(const uint64_t n);
+
+    //(re)generates the table of primes used for trial division; see PrimeTable
+    void loadPrimeTable(const uint64_t bound, const std::string& cachePath = "");
+    //loads a table of defaultPrimeTableBound if none has been loaded yet
+    const PrimeTable& getPrimeTable(void);
 
-    inline bool isPrime(const uint64_t n);
-    //if n is known to have no factors less than a certain number, that number can be passed in as the potentialFactorFloor
-    inline bool isPrime(const uint64_t n, const uint64_t potentialFactorFloor);
+    //bases with no common strong pseudoprimes below each width's limit, jaeschke's set for 32 bits and sinclair's for 64
+    //no fixed set of bases is known to be deterministic through 128 bits, so beyond 64 bits base 2 is followed by a strong lucas test
+    static constexpr std::array<uint64_t, 3> millerRabinBases32 { 2, 7, 61 };
+    static constexpr std::array<uint64_t, 7> millerRabinBases64 { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+    static constexpr std::array<uint64_t, 1> millerRabinBases128 { 2 };
 
-    std::unordered_set<uint32_t> populatePrimeSet();
+    //primes below this are found by trial division before the rho engine takes over
+    static constexpr uint64_t pollardRhoTrialBound = 1u << 8;
+    //small enough to sieve near instantly; trial division continues past it without the table if necessary
+    static constexpr uint64_t defaultPrimeTableBound = 1u << 16;
+    static constexpr uint64_t minPrimeTableBound = pollardRhoTrialBound;
 } 
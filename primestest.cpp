@@ -0,0 +1,36 @@
+#include <cstdint>
+#include <print>
+#include <string>
+#include "primes.hpp"
+#include "utils.hpp"
+
+//checks primality and factorization beyond 64 bits against known primes and strong pseudoprimes
+//exits nonzero if any check fails
+static unsigned failures { 0 };
+
+static void check(const bool passed, const std::string& what) {
+    if (passed) return;
+    std::println(stderr, "failed: {}", what);
+    ++failures;
+}
+
+int main(void) {
+    //mersenne primes
+    for (const unsigned exponent : { 89u, 107u, 127u }) {
+        const unsigned __int128 p { (static_cast<unsigned __int128>(1) << exponent) - 1 };
+        check(primes::isPrimeMillerRabin(p), std::format("2^{} - 1 is prime", exponent));
+    }
+
+    //a strong pseudoprime to each of the first 13 prime bases, which alone once reported it prime
+    const unsigned __int128 pseudoprime { static_cast<unsigned __int128>(1287836182261ull) * 2575672364521ull };
+    check(!primes::isPrimeMillerRabin(pseudoprime), std::format("{} is composite", toDecimalString(pseudoprime)));
+    for (const primes::Engine engine : { primes::Engine::TRIAL_DIVISION, primes::Engine::POLLARD_RHO, primes::Engine::TIERED }) {
+        const Factorization128 found { primes::primeFactorization(pseudoprime, engine) };
+        const auto factors { found.viewFactors() };
+        check(factors.size() == 2 && factors[0].base == 1287836182261ull && factors[0].exp == 1 && factors[1].base == 2575672364521ull && factors[1].exp == 1,
+            std::format("engine {}: {} factored as {}", static_cast<int>(engine), toDecimalString(pseudoprime), found.asString()));
+    }
+
+    std::println("{} failures", failures);
+    return failures != 0;
+}
@@ -0,0 +1,177 @@
+#include "primetable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <numeric>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fastdivisor.hpp"
+
+PrimeTable::PrimeTable(const uint64_t bound_, const std::string& cachePath) : bound(std::min(bound_, maxBound)) {
+    if (cachePath.empty() || !tryMapCache(cachePath)) {
+        sievedHalfGaps = sieveHalfGaps(bound);
+        halfGaps = sievedHalfGaps;
+        if (!cachePath.empty()) writeCache(cachePath);
+    }
+    indexInverseChunks();
+}
+
+PrimeTable::~PrimeTable() {
+    for (size_t c { 0 }; c < chunkBases.size(); ++c) delete[] inverseChunks[c].load(std::memory_order_relaxed);
+    if (mappedFile) munmap(mappedFile, mappedFileSize);
+}
+
+uint64_t PrimeTable::getBound(void) const {
+    return bound;
+}
+
+std::span<const uint8_t> PrimeTable::viewHalfGaps(void) const {
+    return halfGaps;
+}
+
+std::span<const uint64_t> PrimeTable::viewInverses(const size_t chunk) const {
+    const size_t first { chunk * inverseChunkSize }, size { std::min(inverseChunkSize, halfGaps.size() - first) };
+    uint64_t* inverses { inverseChunks[chunk].load(std::memory_order_acquire) };
+    if (inverses) return { inverses, size };
+
+    //threads racing to fill the same chunk each compute it, and all but the first to publish discard their copy
+    uint64_t* computed { new uint64_t[size] };
+    uint64_t prime { chunkBases[chunk] };
+    for (size_t i { 0 }; i < size; ++i) {
+        prime += 2u * halfGaps[first + i];
+        computed[i] = FastDivisor::modularInverse(prime);
+    }
+    if (inverseChunks[chunk].compare_exchange_strong(inverses, computed, std::memory_order_acq_rel, std::memory_order_acquire)) return { computed, size };
+    delete[] computed;
+    return { inverses, size };
+}
+
+void PrimeTable::indexInverseChunks(void) {
+    chunkBases.clear();
+    uint64_t prime { 1 };
+    for (size_t first { 0 }; first < halfGaps.size(); first += inverseChunkSize) {
+        chunkBases.push_back(prime);
+        const std::span<const uint8_t> chunk { halfGaps.subspan(first, std::min(inverseChunkSize, halfGaps.size() - first)) };
+        prime += 2u * std::accumulate(chunk.begin(), chunk.end(), uint64_t { 0 });
+    }
+    inverseChunks = std::make_unique<std::atomic<uint64_t*>[]>(chunkBases.size());
+}
+
+bool PrimeTable::tryMapCache(const std::string& cachePath) {
+    const int fd { open(cachePath.c_str(), O_RDONLY) };
+    if (fd < 0) return false;
+
+    cacheHeader header;
+    struct stat fileInfo;
+    const bool usable { fstat(fd, &fileInfo) == 0
+        && read(fd, &header, sizeof(header)) == sizeof(header)
+        && !std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic))
+        && header.bound >= bound
+        && static_cast<uint64_t>(fileInfo.st_size) == sizeof(header) + header.primeCount };
+
+    if (usable) {
+        mappedFileSize = fileInfo.st_size;
+        void* mapping { mmap(nullptr, mappedFileSize, PROT_READ, MAP_SHARED, fd, 0) };
+        if (mapping != MAP_FAILED) {
+            mappedFile = mapping;
+            //a larger cached table is used in its entirety, as additional primes never hurt
+            bound = header.bound;
+            halfGaps = { static_cast<const uint8_t*>(mappedFile) + sizeof(header), header.primeCount };
+        }
+    }
+    close(fd);
+    return mappedFile;
+}
+
+void PrimeTable::writeCache(const std::string& cachePath) const {
+    //written in full under a temporary name in the same directory, then renamed over cachePath,
+    //as truncating the file in place would pull the pages out from under any process that has it mapped
+    std::string tempPath { cachePath + ".XXXXXX" };
+    const int fd { mkstemp(tempPath.data()) };
+    if (fd < 0) return;
+    FILE* cacheFile { fdopen(fd, "wb") };
+    if (!cacheFile) {
+        close(fd);
+        unlink(tempPath.c_str());
+        return;
+    }
+
+    cacheHeader header { .bound = bound, .primeCount = halfGaps.size() };
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    //mkstemp creates the file readable by its owner only, but the cache is meant to be shared
+    const bool written { fchmod(fd, 0644) == 0
+        && std::fwrite(&header, sizeof(header), 1, cacheFile) == 1
+        && std::fwrite(halfGaps.data(), 1, halfGaps.size(), cacheFile) == halfGaps.size() };
+    //processes mapping the old file keep its inode, and any that open cachePath from here on find the new one
+    if (std::fclose(cacheFile) != 0 || !written || rename(tempPath.c_str(), cachePath.c_str()) != 0) unlink(tempPath.c_str());
+}
+
+std::vector<uint8_t> PrimeTable::sieveHalfGaps(const uint64_t bound) {
+    //index i of the sieve represents the odd number 2i + 1
+    //2^15 bytes per segment, sized to stay within a typical L1 data cache
+    static constexpr uint64_t segmentSize = 1u << 15;
+    //3 * 5 * 7; the pattern of odd multiples of 3, 5, and 7 repeats with this period in the index space
+    static constexpr uint64_t wheelPeriod = 105;
+    static constexpr std::array<uint64_t, 3> wheelPrimes { 3, 5, 7 };
+
+    std::array<uint8_t, wheelPeriod> wheelPattern;
+    for (uint64_t i { 0 }; i < wheelPeriod; ++i)
+        wheelPattern[i] = std::ranges::none_of(wheelPrimes, [&](uint64_t p){ return (2 * i + 1) % p == 0; });
+
+    //simple sieve of the odd primes through sqrt(bound), which are used to sieve each segment
+    const uint64_t sqrtBound { static_cast<uint64_t>(std::sqrt(bound)) + 1 };
+    std::vector<uint8_t> isSmallComposite(sqrtBound + 1, 0);
+    //pairs of {sieving prime, index of its next odd multiple to be crossed off}
+    std::vector<std::pair<uint64_t, uint64_t>> sievingPrimes;
+    for (uint64_t p { 3 }; p <= sqrtBound; p += 2) {
+        if (isSmallComposite[p]) continue;
+        for (uint64_t multiple { p * p }; multiple <= sqrtBound; multiple += 2 * p) isSmallComposite[multiple] = 1;
+        //the wheel pattern has already crossed off multiples of these
+        if (p > wheelPrimes.back()) sievingPrimes.emplace_back(p, p * p / 2);
+    }
+
+    std::vector<uint8_t> halfGaps;
+    //prime counting estimate with a margin, to avoid reallocating
+    if (bound > 1) halfGaps.reserve(static_cast<size_t>(1.1 * bound / std::log(bound)) + 16);
+    uint64_t lastPrime { 1 };
+
+    std::vector<uint8_t> segment(segmentSize);
+    const uint64_t indexCount { bound / 2 };
+    for (uint64_t low { 0 }; low < indexCount; low += segmentSize) {
+        const uint64_t high { std::min(low + segmentSize, indexCount) };
+
+        //copies the wheel pattern, starting at the appropriate phase for this segment
+        for (uint64_t i { 0 }, phase { low % wheelPeriod }; i < high - low; phase = 0) {
+            const uint64_t chunk { std::min(wheelPeriod - phase, (high - low) - i) };
+            std::memcpy(segment.data() + i, wheelPattern.data() + phase, chunk);
+            i += chunk;
+        }
+        if (low == 0) {
+            segment[0] = 0; //1 is not prime
+            for (uint64_t p : wheelPrimes) if (p / 2 < high) segment[p / 2] = 1;
+        }
+
+        for (auto& [p, nextIndex] : sievingPrimes) {
+            //consecutive odd multiples of p are p apart in the index space
+            for (; nextIndex < high; nextIndex += p) segment[nextIndex - low] = 0;
+        }
+
+        //scans 8 entries at a time, as most words contain few primes (and many contain none)
+        //segmentSize is a multiple of 8, and entries past high are zeroed, so whole words may be read
+        std::fill(segment.begin() + (high - low), segment.end(), 0);
+        for (uint64_t i { 0 }; i < high - low; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, segment.data() + i, sizeof(word));
+            for (; word; word &= word - 1) {
+                //each nonzero entry is exactly 1, so the lowest set bit identifies the byte
+                const uint64_t prime { 2 * (low + i + __builtin_ctzll(word) / 8) + 1 };
+                halfGaps.push_back(static_cast<uint8_t>((prime - lastPrime) / 2));
+                lastPrime = prime;
+            }
+        }
+    }
+    return halfGaps;
+}
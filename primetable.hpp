@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+//compact table of every odd prime below a bound, generated once by a segmented sieve of eratosthenes
+//primes are stored as half the gap from the previous prime (starting from 1),
+//which fits in a byte for all gaps below 2^32 (the largest being 336)
+//i.e. the nth odd prime == 1 + 2 * sum(halfGaps[0..n])
+class PrimeTable {
+public:
+    //sieves all odd primes below bound, or maps them from cachePath if it holds a table covering at least bound
+    //if cachePath is nonempty and no usable table is found there, the newly sieved table is written to it
+    PrimeTable(const uint64_t bound_, const std::string& cachePath = "");
+    ~PrimeTable();
+
+    PrimeTable(const PrimeTable&) = delete;
+    PrimeTable& operator=(const PrimeTable&) = delete;
+
+    //every prime below this value is present in the table
+    uint64_t getBound(void) const;
+
+    std::span<const uint8_t> viewHalfGaps(void) const;
+
+    //FastDivisor inverses of the primes with indexes in [chunk * inverseChunkSize, (chunk + 1) * inverseChunkSize), clipped to the table
+    //each chunk is computed the first time it is viewed and kept, so trial division by table primes never recomputes an inverse;
+    //this costs 8 bytes per prime reached, up to ~1.6 GB for a table of maxBound walked in full
+    //safe to call from any number of threads at once
+    //precondition: chunk * inverseChunkSize < viewHalfGaps().size()
+    std::span<const uint64_t> viewInverses(const size_t chunk) const;
+
+    //sufficient to trial divide any 64 bit n
+    static constexpr uint64_t maxBound = 1ull << 32;
+    //128 KiB of inverses per chunk
+    static constexpr size_t inverseChunkSize = 1u << 14;
+
+private:
+    //returns true if cachePath contained a table covering at least bound, which is then mapped into memory
+    bool tryMapCache(const std::string& cachePath);
+    void writeCache(const std::string& cachePath) const;
+
+    //records the prime preceding each inverse chunk, from which the chunk's primes are found by their gaps
+    void indexInverseChunks(void);
+
+    //segmented odd only sieve, with multiples of 3, 5, and 7 removed from each segment by copying a precomputed wheel pattern
+    static std::vector<uint8_t> sieveHalfGaps(const uint64_t bound);
+
+    struct cacheHeader {
+        char magic[8];
+        uint64_t bound;
+        uint64_t primeCount;
+    };
+    static constexpr char cacheMagic[8] = "PRMTBL1";
+
+    uint64_t bound;
+
+    //holds the table if it was sieved this run, otherwise empty
+    std::vector<uint8_t> sievedHalfGaps;
+    //holds the table if it was loaded from a cache file, otherwise nullptr
+    void* mappedFile = nullptr;
+    size_t mappedFileSize = 0;
+
+    //view of whichever of the above is in use
+    std::span<const uint8_t> halfGaps;
+
+    //chunkBases[c] is the odd prime (or 1) before the first prime of inverse chunk c
+    std::vector<uint64_t> chunkBases;
+    //null until each chunk is first viewed; owned by the table
+    std::unique_ptr<std::atomic<uint64_t*>[]> inverseChunks;
+};
@@ -0,0 +1,95 @@
+#include "rangesieve.hpp"
+
+RangeSieve::RangeSieve(const primes::Engine cofactorEngine_) : cofactorEngine(cofactorEngine_) {
+    cofactors.reserve(blockSize);
+    block.reserve(blockSize);
+}
+
+std::span<const FactorCalculationInfo> RangeSieve::factorBlock(const uint64_t low, const size_t count, const bool countHardwareEvents) {
+    const HardwareCounts countsBefore { countHardwareEvents ? PerfCounters::forThisThread().read() : HardwareCounts() };
+    #ifdef COUNT_OPERATIONS
+    //discards anything counted outside of the block
+    OperationCounter::take();
+    #endif
+    const uint64_t start { TscClock::start() };
+
+    block.clear();
+    cofactors.resize(count);
+    for (size_t i { 0 }; i < count; ++i) {
+        block.emplace_back(low + i);
+        cofactors[i] = low + i;
+    }
+    //0 is a multiple of every prime, so it is excluded from sieving (and has no prime factorization regardless)
+    if (low == 0 && count) cofactors[0] = 1;
+
+    //powers of 2 are stripped by counting trailing zeros rather than dividing
+    {
+        const OperationCounter::StageScope stage(OperationCounts::POWERS_OF_TWO);
+        for (size_t i { low & 0b1 }; i < count; i += 2) {
+            if (cofactors[i] < 2) continue;
+            const int exp { __builtin_ctzll(cofactors[i]) };
+            cofactors[i] >>= exp;
+            block[i].factorization.addNewFactor(2, exp);
+        }
+    }
+
+    //primes through sqrt of the greatest number in the block are sufficient to fully factor every number in it,
+    //provided the prime table reaches that far
+    const uint64_t maxLessorDivisor { primes::isqrt(low + count - 1) };
+    const PrimeTable& table { primes::getPrimeTable() };
+    const std::span<const uint8_t> halfGaps { table.viewHalfGaps() };
+    uint64_t divisor { 1 };
+    {
+        const OperationCounter::StageScope stage(OperationCounts::TABLE_PRIMES);
+        for (size_t j { 0 }; j < halfGaps.size() && divisor <= maxLessorDivisor; ) {
+            const size_t chunkFirst { j - j % PrimeTable::inverseChunkSize };
+            const std::span<const uint64_t> inverses { table.viewInverses(j / PrimeTable::inverseChunkSize) };
+            for (; j < chunkFirst + inverses.size(); ++j) {
+                divisor += 2u * halfGaps[j];
+                if (divisor > maxLessorDivisor) break;
+
+                //index of the first multiple of divisor in the block, skipping 0
+                size_t i { low % divisor ? divisor - (low % divisor) : (low ? 0 : divisor) };
+                //every cofactor visited is a multiple, so only exact division is needed
+                const FastDivisor fastDivisor(divisor, inverses[j - chunkFirst]);
+                for (; i < count; i += divisor) {
+                    uint_fast8_t exp { 0 };
+                    //every test made, including the one that ends the loop
+                    for (; fastDivisor.divides(cofactors[i]); ++exp) cofactors[i] = fastDivisor.divideExact(cofactors[i]);
+                    OperationCounter::countTrialDivisions(exp + 1u);
+                    block[i].factorization.addNewFactor(divisor, exp);
+                }
+            }
+        }
+    }
+    //every prime below this has been divided out of each cofactor
+    const uint64_t factorFloor { std::min(maxLessorDivisor + 1, table.getBound()) };
+
+    for (size_t i { 0 }; i < count; ++i) {
+        if (cofactors[i] == 1) continue;
+        //a cofactor with no factors through its own sqrt is prime
+        if (primes::isqrt(cofactors[i]) < factorFloor) block[i].factorization.addNewFactor(cofactors[i], 1);
+        //only possible when the table falls short of sqrt of the block's greatest number
+        else {
+            const Factorization cofactorFactorization { primes::primeFactorization(cofactors[i], cofactorEngine) };
+            for (const auto& [base, exp] : cofactorFactorization.viewFactors()) block[i].factorization.addNewFactor(base, exp);
+        }
+    }
+
+    //rounded to the nearest tick
+    const uint64_t amortizedCalcTicks { ((TscClock::stop() - start) + count / 2) / std::max<size_t>(count, 1) };
+    const HardwareCounts amortizedCounts { countHardwareEvents ? (PerfCounters::forThisThread().read() - countsBefore) / std::max<size_t>(count, 1) : HardwareCounts() };
+    #ifdef COUNT_OPERATIONS
+    //sieving shares each prime's work between the numbers it visits, so each number is given the block's mean
+    const OperationCounts amortizedOperations { OperationCounter::take() / std::max<size_t>(count, 1) };
+    #endif
+    for (FactorCalculationInfo& infoSet : block) {
+        infoSet.calcTicks = amortizedCalcTicks;
+        infoSet.hardwareCounts = amortizedCounts;
+        #ifdef COUNT_OPERATIONS
+        infoSet.operationCounts = amortizedOperations;
+        #endif
+    }
+
+    return block;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "calculationinfo.hpp"
+#include "primes.hpp"
+
+//factors consecutive numbers a block at a time by sieving with the prime table, rather than factoring each one independently
+//each table prime p only visits the multiples of p within a block, for roughly O(log log n) amortized work per number
+class RangeSieve {
+public:
+    //cofactorEngine handles whatever remains of a number after the table primes are divided out, if it is not known to be prime
+    RangeSieve(const primes::Engine cofactorEngine_);
+
+    //factors every number in [low, low + count), timing the block as a whole
+    //each resulting FactorCalculationInfo's calcTicks is the block's amortized ticks per number,
+    //and likewise its hardwareCounts if countHardwareEvents, see PerfCounters, and its operationCounts in builds with COUNT_OPERATIONS defined
+    //precondition: low + count - 1 does not overflow, count <= blockSize
+    std::span<const FactorCalculationInfo> factorBlock(const uint64_t low, const size_t count, const bool countHardwareEvents = false);
+
+    //2^15 cofactors of 8 bytes each fit in a typical L2 cache
+    static constexpr size_t blockSize = 1u << 15;
+
+private:
+    primes::Engine cofactorEngine;
+
+    //the portion of each number in the block not yet factored
+    std::vector<uint64_t> cofactors;
+    std::vector<FactorCalculationInfo> block;
+};
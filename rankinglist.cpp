@@ -1,23 +1,45 @@
 #include "rankinglist.hpp"
 
-bool fastestComparator::operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const {
-    return newItem.calcTime < existingItem.calcTime;
+fastestComparator::key_t fastestComparator::key(const FactorRecord& item) {
+    return item.calcTicks;
 }
 
-bool slowestComparator::operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const {
-    return newItem.calcTime > existingItem.calcTime;
+bool fastestComparator::outranks(const key_t& newKey, const key_t& existingKey) {
+    return newKey < existingKey;
 }
 
-bool totalFactorsComparator::operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const {
-    return newItem.factorization.getFactorCount() > existingItem.factorization.getFactorCount()  
-        //if tied, tie break with unique factor count
-        || (newItem.factorization.getFactorCount() == existingItem.factorization.getFactorCount() 
-        && newItem.factorization.getUniqueFactorCount() > existingItem.factorization.getUniqueFactorCount());
+slowestComparator::key_t slowestComparator::key(const FactorRecord& item) {
+    return item.calcTicks;
 }
 
-bool uniqueFactorsComparator::operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const {
-    return newItem.factorization.getUniqueFactorCount() > existingItem.factorization.getUniqueFactorCount()
-        //if tied, tie break with total factor count
-        || (newItem.factorization.getUniqueFactorCount() == existingItem.factorization.getUniqueFactorCount() 
-        && newItem.factorization.getFactorCount() > existingItem.factorization.getFactorCount());
+bool slowestComparator::outranks(const key_t& newKey, const key_t& existingKey) {
+    return newKey > existingKey;
 }
+
+totalFactorsComparator::key_t totalFactorsComparator::key(const FactorRecord& item) {
+    return { item.factorCount, item.uniqueFactorCount };
+}
+
+bool totalFactorsComparator::outranks(const key_t& newKey, const key_t& existingKey) {
+    //lexicographic, so that ties are broken by the second element
+    return newKey > existingKey;
+}
+
+uniqueFactorsComparator::key_t uniqueFactorsComparator::key(const FactorRecord& item) {
+    return { item.uniqueFactorCount, item.factorCount };
+}
+
+bool uniqueFactorsComparator::outranks(const key_t& newKey, const key_t& existingKey) {
+    //lexicographic, so that ties are broken by the second element
+    return newKey > existingKey;
+}
+
+#ifdef COUNT_OPERATIONS
+mostOperationsComparator::key_t mostOperationsComparator::key(const OperationCountedRecord& item) {
+    return item.operationCounts.getOperationCount();
+}
+
+bool mostOperationsComparator::outranks(const key_t& newKey, const key_t& existingKey) {
+    return newKey > existingKey;
+}
+#endif
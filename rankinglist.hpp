@@ -1,80 +1,169 @@
 #pragma once
 
 #include <print>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <functional>
-#include <set>
+#include <utility>
 #include "calculationinfo.hpp"
 #include "utils.hpp"
 
-struct fastestComparator       { bool operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const; };
-struct slowestComparator       { bool operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const; };
-struct totalFactorsComparator  { bool operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const; };
-struct uniqueFactorsComparator { bool operator()(const FactorCalculationInfo& newItem, const FactorCalculationInfo& existingItem) const; };
+//each comparator reduces an item to the key it is ranked by, and decides whether one key outranks another
+//ties never outrank, so earlier items keep their place
+//untimed items are never ranked by time, as their calcTicks is no measurement
+struct fastestComparator {
+    using key_t = uint64_t;
+    static key_t key(const FactorRecord& item);
+    static bool outranks(const key_t& newKey, const key_t& existingKey);
+};
+struct slowestComparator {
+    using key_t = uint64_t;
+    static key_t key(const FactorRecord& item);
+    static bool outranks(const key_t& newKey, const key_t& existingKey);
+};
+//ties broken with unique factor count
+struct totalFactorsComparator {
+    using key_t = std::pair<uint_fast8_t, uint_fast8_t>;
+    static key_t key(const FactorRecord& item);
+    static bool outranks(const key_t& newKey, const key_t& existingKey);
+};
+//ties broken with total factor count
+struct uniqueFactorsComparator {
+    using key_t = std::pair<uint_fast8_t, uint_fast8_t>;
+    static key_t key(const FactorRecord& item);
+    static bool outranks(const key_t& newKey, const key_t& existingKey);
+};
 
-template<class Comp>
+#ifdef COUNT_OPERATIONS
+//see OperationCounts::getOperationCount
+//ranks OperationCountedRecords only
+struct mostOperationsComparator {
+    using key_t = uint64_t;
+    static key_t key(const OperationCountedRecord& item);
+    static bool outranks(const key_t& newKey, const key_t& existingKey);
+};
+#endif
+
+//the best maxSize items seen, in fixed inline storage
+//kept as a binary heap with the worst item at the root, so that it can be replaced in O(log maxSize) moves
+//once full, the worst item's key is cached so that the common case of an item that does not rank costs a single comparison
+//Record is FactorRecord, or a record extending it with whatever else the list's printout shows; see FactorRecord
+template<class Comp, class Record = FactorRecord>
 class RankingList {
 public:
-    RankingList(size_t maxSize_) : maxSize(maxSize_), rankedItems(Comp()) {};
+    //no more than maxCapacity items are kept regardless of maxSize_
+    RankingList(size_t maxSize_) : maxSize(std::min(maxSize_, maxCapacity)) {};
+
+    //compares newItem against the existing ranked items, and keeps it if it outranks the worst of them
+    void rankIfApplicable(const Record& newItem);
+
+    //ranks each of other's items as if they had been passed to this list directly
+    void merge(const RankingList& other);
+
+    //the best item so far, or nullptr if there are none
+    const Record* viewBest(void) const;
 
-    //compares newItem against the existing ranked items, and inserts in order
-    void rankIfApplicable(const FactorCalculationInfo& newItem);
+    //puts the items in rank order (best first) for iteration
+    //the list can still be ranked into afterwards, but must be sorted again before iterating
+    void sortRanks(void);
+
+    //enough for any list sized from log10 of a 64 bit input count
+    static constexpr size_t maxCapacity = 20;
 
 private:
     bool isFilled(void) const;
 
-    bool outranksWorstItem(const FactorCalculationInfo& newItem) const;
+    //heap order with the worst item at the front
+    static bool heapOrder(const Record& a, const Record& b);
 
     size_t maxSize;
-    std::multiset<FactorCalculationInfo, Comp> rankedItems;
+    size_t size = 0;
+    bool heapified = true;
+    std::array<Record, maxCapacity> rankedItems;
+    //valid only once filled
+    typename Comp::key_t worstKey;
 
 public:
-    using container_t = decltype(RankingList<Comp>::rankedItems);
-    container_t::const_iterator cbegin() const;
-    container_t::const_iterator cend() const;
+    //iterates in rank order
+    //precondition: sortRanks has been called since the last item was ranked
+    using const_iterator = const Record*;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
 };
 
-template<class Comp>
-void RankingList<Comp>::rankIfApplicable(const FactorCalculationInfo& newItem) {
-    if (!isFilled()) rankedItems.insert(newItem);
-    else if (outranksWorstItem(newItem)) {
-        rankedItems.erase(std::prev(rankedItems.end()));
-        rankedItems.insert(newItem);
+template<class Comp, class Record>
+void RankingList<Comp, Record>::rankIfApplicable(const Record& newItem) {
+    if (!maxSize || (isFilled() && !Comp::outranks(Comp::key(newItem), worstKey))) return;
+
+    if (!heapified) {
+        std::make_heap(rankedItems.begin(), rankedItems.begin() + size, heapOrder);
+        heapified = true;
     }
+    if (isFilled()) 
+        std::pop_heap(rankedItems.begin(), rankedItems.begin() + size--, heapOrder);
+    rankedItems[size++] = newItem;
+    std::push_heap(rankedItems.begin(), rankedItems.begin() + size, heapOrder);
+    if (isFilled()) worstKey = Comp::key(rankedItems.front());
+}
+
+template<class Comp, class Record>
+void RankingList<Comp, Record>::merge(const RankingList& other) {
+    for (size_t i { 0 }; i < other.size; ++i) rankIfApplicable(other.rankedItems[i]);
+}
+
+template<class Comp, class Record>
+const Record* RankingList<Comp, Record>::viewBest() const {
+    if (!size) return nullptr;
+    //the heap only orders the worst item, but there are few enough items for a linear scan
+    return &*std::min_element(rankedItems.begin(), rankedItems.begin() + size, [](const Record& a, const Record& b){ 
+        return Comp::outranks(Comp::key(a), Comp::key(b)); 
+    });
+}
+
+template<class Comp, class Record>
+void RankingList<Comp, Record>::sortRanks() {
+    //stable so that tied items stay in the order they were kept in
+    std::stable_sort(rankedItems.begin(), rankedItems.begin() + size, [](const Record& a, const Record& b){ 
+        return Comp::outranks(Comp::key(a), Comp::key(b)); 
+    });
+    heapified = false;
 }
 
-template<class Comp>
-bool RankingList<Comp>::isFilled() const {
-    return rankedItems.size() == maxSize;
+template<class Comp, class Record>
+bool RankingList<Comp, Record>::isFilled() const {
+    return size == maxSize;
 }
 
-template<class Comp>
-bool RankingList<Comp>::outranksWorstItem(const FactorCalculationInfo& newItem) const {
-    return rankedItems.key_comp()(newItem, *std::prev(rankedItems.cend()));
+template<class Comp, class Record>
+bool RankingList<Comp, Record>::heapOrder(const Record& a, const Record& b) {
+    return Comp::outranks(Comp::key(a), Comp::key(b));
 }
 
-template<class Comp>
-RankingList<Comp>::container_t::const_iterator RankingList<Comp>::cbegin() const {
-    return rankedItems.cbegin();
+template<class Comp, class Record>
+RankingList<Comp, Record>::const_iterator RankingList<Comp, Record>::cbegin() const {
+    return rankedItems.data();
 }
 
-template<class Comp>
-RankingList<Comp>::container_t::const_iterator RankingList<Comp>::cend() const {
-    return rankedItems.cend();
+template<class Comp, class Record>
+RankingList<Comp, Record>::const_iterator RankingList<Comp, Record>::cend() const {
+    return rankedItems.data() + size;
 }
 
-template<class CompLeft, class CompRight>
-inline void printRecordLists(const RankingList<CompLeft>& leftRecordList, const RankingList<CompRight>& rightRecordList, FILE* outStream = stdout) {
-    printRecordLists<CompLeft, CompRight>(leftRecordList, rightRecordList, 
+template<class LeftList, class RightList>
+inline void printRecordLists(const LeftList& leftRecordList, const RightList& rightRecordList, FILE* outStream = stdout) {
+    printRecordLists(leftRecordList, rightRecordList, 
         //default format shows rank and calcTime only
-        [](const RankingList<CompLeft>::container_t::const_iterator& leftIt){ return std::format("{}", leftIt->calcTime); },
-        [](const RankingList<CompRight>::container_t::const_iterator& rightIt){ return std::format("{}", rightIt->calcTime); }, outStream
+        [](const LeftList::const_iterator& leftIt){ return std::format("{}", leftIt->getCalcTime()); },
+        [](const RightList::const_iterator& rightIt){ return std::format("{}", rightIt->getCalcTime()); }, outStream
     );
 }
 
-template<class CompLeft, class CompRight>
-inline void printRecordLists(const RankingList<CompLeft>& leftRecordList, const RankingList<CompRight>& rightRecordList, 
-    std::function<const std::string(const typename RankingList<CompLeft>::container_t::const_iterator& leftIt)>&& leftInfoFormat, 
-    std::function<const std::string(const typename RankingList<CompRight>::container_t::const_iterator& rightIt)>&& rightInfoFormat, 
+//factorizations are recomputed here, see FactorRecord
+template<class LeftList, class RightList>
+inline void printRecordLists(const LeftList& leftRecordList, const RightList& rightRecordList, 
+    std::function<const std::string(const typename LeftList::const_iterator& leftIt)>&& leftInfoFormat, 
+    std::function<const std::string(const typename RightList::const_iterator& rightIt)>&& rightInfoFormat, 
     FILE* outStream = stdout) {
     
     unsigned rank = 1;
@@ -84,8 +173,8 @@ inline void printRecordLists(const RankingList<CompLeft>& leftRecordList, const
             std::format("#{}: {}", rank, leftInfoFormat(leftIt)), panelWidth,
             std::format("#{}: {}", rank, rightInfoFormat(rightIt)),
             //second line is always n == factorization of n, doesn't need custom formatting function 
-            std::format("{} ={}", leftIt->n, leftIt->factorization.asString()), panelWidth,
-            std::format("{} ={}", rightIt->n, rightIt->factorization.asString())
+            std::format("{} ={}", leftIt->n, leftIt->formatFactorization()), panelWidth,
+            std::format("{} ={}", rightIt->n, rightIt->formatFactorization())
         );
     }
 }
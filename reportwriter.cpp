@@ -0,0 +1,72 @@
+#include "reportwriter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include "utils.hpp"
+
+std::mutex ReportWriter::registryLock;
+std::vector<ReportWriter*> ReportWriter::registry;
+
+ReportWriter& ReportWriter::forThisThread(void) {
+    thread_local ReportWriter writer;
+    return writer;
+}
+
+void ReportWriter::flushAll(void) {
+    std::lock_guard lock(registryLock);
+    for (ReportWriter* writer : registry) writer->flush();
+}
+
+ReportWriter::ReportWriter() : buffer(std::make_unique<char[]>(bufferSize)) {
+    std::lock_guard lock(registryLock);
+    registry.push_back(this);
+}
+
+ReportWriter::~ReportWriter() {
+    flush();
+    std::lock_guard lock(registryLock);
+    std::erase(registry, this);
+}
+
+template<class T>
+void ReportWriter::report(const BasicFactorCalculationInfo<T>& info, const uint64_t index, const uint64_t total) {
+    if (bufferSize - used < maxReportSize) flush();
+    char* out { buffer.get() + used };
+    //to_chars never writes more than 20 digits of a 64 bit integer
+    const auto writeNumber = [&](const uint64_t value) { out = std::to_chars(out, out + 20, value).ptr; };
+
+    if (index) {
+        *out++ = '(';
+        writeNumber(index);
+        if (total) {
+            *out++ = '/';
+            writeNumber(total);
+        }
+        out = std::copy_n("): ", 3, out);
+    }
+    //n is repeated as factorizations from multiple threads may be interleaved
+    if constexpr (sizeof(T) > sizeof(uint64_t)) out = toDecimalChars(out, info.n);
+    else writeNumber(info.n);
+    out = std::copy_n(" =", 2, out);
+    out = info.factorization.formatTo(out);
+    *out++ = '\n';
+    if (info.isTimed()) {
+        //6 significant digits, as calcTime is converted from ticks and so carries noise in every digit beyond the first few
+        //as a double, since long double conversion is several times slower
+        out = std::to_chars(out, buffer.get() + bufferSize, static_cast<double>(info.getCalcTime().count()), std::chars_format::general, 6).ptr;
+        out = std::copy_n("ms\n\n", 4, out);
+    }
+    else if (info.isCacheHit()) out = std::copy_n("cached\n\n", 8, out);
+    else out = std::copy_n("untimed\n\n", 9, out);
+    used = out - buffer.get();
+}
+
+void ReportWriter::flush(void) {
+    if (!used) return;
+    //a single call, so that stdio's own lock keeps the block whole relative to other output
+    std::fwrite(buffer.get(), 1, used, stdout);
+    used = 0;
+}
+
+template void ReportWriter::report(const BasicFactorCalculationInfo<uint64_t>&, const uint64_t, const uint64_t);
+template void ReportWriter::report(const BasicFactorCalculationInfo<unsigned __int128>&, const uint64_t, const uint64_t);
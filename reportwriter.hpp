@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "calculationinfo.hpp"
+
+//formats per input factorization reports straight into a large per thread buffer, without temporary strings,
+//and writes each buffer to stdout in a single call once it is nearly full
+//each report is written whole, so reports from different threads may interleave but never split
+class ReportWriter {
+public:
+    //the calling thread's writer, created on first use
+    static ReportWriter& forThisThread(void);
+    //writes out every thread's buffered reports
+    //precondition: no other thread is adding reports
+    static void flushAll(void);
+
+    //appends "(index/total): n = factorization", or "(index): ..." if total is 0, or just "n = ..." if index is also 0,
+    //followed by calcTime and a blank line
+    template<class T>
+    void report(const BasicFactorCalculationInfo<T>& info, const uint64_t index = 0, const uint64_t total = 0);
+    void flush(void);
+
+    ~ReportWriter();
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    static constexpr size_t bufferSize = 1u << 20;
+    //longest possible report: two index numbers, a 128 bit n, its factorization and a duration
+    static constexpr size_t maxReportSize = 128 + BasicFactorization<unsigned __int128>::maxFormattedLength;
+
+private:
+    ReportWriter();
+
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+
+    //every live writer, so that flushAll can reach the buffers of other threads
+    static std::mutex registryLock;
+    static std::vector<ReportWriter*> registry;
+};
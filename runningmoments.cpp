@@ -0,0 +1,65 @@
+#include "runningmoments.hpp"
+
+void RunningMoments::add(const long double x) {
+    ++count;
+    const long double delta { x - mean };
+    mean += delta / count;
+    m2 += delta * (x - mean);
+
+    if (x == 0) ++zeroCount;
+    else {
+        reciprocals.add(1 / x);
+        logs.add(std::log(x));
+    }
+}
+
+void RunningMoments::merge(const RunningMoments& other) {
+    if (!other.count) return;
+    //Chan et al.'s pairwise combination of Welford states
+    const uint64_t combinedCount { count + other.count };
+    const long double delta { other.mean - mean };
+    mean += delta * other.count / combinedCount;
+    m2 += other.m2 + delta * delta * count * other.count / combinedCount;
+    count = combinedCount;
+
+    zeroCount += other.zeroCount;
+    reciprocals.merge(other.reciprocals);
+    logs.merge(other.logs);
+}
+
+uint64_t RunningMoments::getCount(void) const {
+    return count;
+}
+
+long double RunningMoments::arithmeticMean(void) const {
+    return mean;
+}
+
+long double RunningMoments::harmonicMean(void) const {
+    return (!count || zeroCount) ? 0 : count / reciprocals.value();
+}
+
+long double RunningMoments::geometricMean(void) const {
+    return (!count || zeroCount) ? 0 : std::exp(logs.value() / count);
+}
+
+long double RunningMoments::standardDeviation(void) const {
+    return count ? std::sqrt(m2 / count) : 0;
+}
+
+void RunningMoments::CompensatedSum::add(const long double x) {
+    const long double total { sum + x };
+    //recovers the low order bits lost from whichever operand was smaller
+    if (std::fabs(sum) >= std::fabs(x)) compensation += (sum - total) + x;
+    else compensation += (x - total) + sum;
+    sum = total;
+}
+
+void RunningMoments::CompensatedSum::merge(const CompensatedSum& other) {
+    add(other.sum);
+    compensation += other.compensation;
+}
+
+long double RunningMoments::CompensatedSum::value(void) const {
+    return sum + compensation;
+}
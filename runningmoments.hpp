@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+//one pass mean, variance, harmonic mean and geometric mean of a stream of nonnegative values
+//variance uses Welford's update, and the reciprocal and log sums are compensated so that billions of small terms do not lose precision
+//sets of moments gathered separately can be merged into the moments of their combined streams
+class RunningMoments {
+public:
+    void add(const long double x);
+    void merge(const RunningMoments& other);
+
+    uint64_t getCount(void) const;
+    long double arithmeticMean(void) const;
+    //0 if any value added was 0
+    long double harmonicMean(void) const;
+    //0 if any value added was 0
+    long double geometricMean(void) const;
+    //population standard deviation
+    long double standardDeviation(void) const;
+
+private:
+    //Neumaier's variant of Kahan summation, which also holds up when a term is larger than the running sum
+    struct CompensatedSum {
+        long double sum { 0 }, compensation { 0 };
+        void add(const long double x);
+        void merge(const CompensatedSum& other);
+        long double value(void) const;
+    };
+
+    uint64_t count { 0 };
+    //values of 0 have no reciprocal or log, so are only counted
+    uint64_t zeroCount { 0 };
+    long double mean { 0 };
+    //sum of squared deviations from the mean
+    long double m2 { 0 };
+    CompensatedSum reciprocals, logs;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//a value published by one writer thread and read by any number of others, without either side ever blocking
+//the writer bumps the sequence to odd, copies the value in, then bumps it to even; a reader retries until it copies the value out
+//between two reads of the same even sequence, so it never keeps a half written value, and the writer never waits on readers
+//the value is held as relaxed atomic words, so that a read racing a write is a retry rather than a data race
+template<class T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>, "values are copied word by word");
+
+public:
+    //precondition: only ever called by one thread at a time
+    void store(const T& value) {
+        std::array<uint64_t, wordCount> words {};
+        std::memcpy(words.data(), &value, sizeof(T));
+        const uint64_t sequence_ { sequence.load(std::memory_order_relaxed) };
+        sequence.store(sequence_ + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i { 0 }; i < wordCount; ++i) storage[i].store(words[i], std::memory_order_relaxed);
+        sequence.store(sequence_ + 2, std::memory_order_release);
+    }
+
+    //the last value stored, or a default constructed T if there has been none
+    T load(void) const {
+        std::array<uint64_t, wordCount> words;
+        for (uint64_t before, after; ; ) {
+            before = sequence.load(std::memory_order_acquire);
+            if (!before) return T();
+            if (before & 0b1) continue;
+            for (size_t i { 0 }; i < wordCount; ++i) words[i] = storage[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+            if (before == after) break;
+        }
+        //T may have default member initializers, which make it nontrivial but not any less safe to copy bytewise
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t wordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence { 0 };
+    std::array<std::atomic<uint64_t>, wordCount> storage {};
+};
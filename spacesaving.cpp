@@ -0,0 +1,133 @@
+#include "spacesaving.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+SpaceSavingCounter::SpaceSavingCounter(const size_t capacity_) : 
+    capacity(std::max<size_t>(capacity_, 1)), 
+    index(std::bit_ceil(2 * capacity), 0) {
+    entries.reserve(capacity);
+    slotOfEntry.reserve(capacity);
+}
+
+void SpaceSavingCounter::add(const uint64_t key, const uint64_t amount) {
+    const size_t slot { findSlot(key) };
+    if (index[slot]) {
+        const size_t i { index[slot] - 1u };
+        entries[i].count += amount;
+        siftDown(i);
+    }
+    else if (entries.size() < capacity) {
+        entries.push_back({ key, amount, 0 });
+        slotOfEntry.push_back(0);
+        insertIntoIndex(key, entries.size() - 1);
+        siftUp(entries.size() - 1);
+    }
+    else {
+        //the least counted key is evicted, and its count becomes the newcomer's overestimate
+        eraseFromIndex(entries[0].key);
+        entries[0] = { key, entries[0].count + amount, entries[0].count };
+        insertIntoIndex(key, 0);
+        siftDown(0);
+    }
+}
+
+void SpaceSavingCounter::merge(const SpaceSavingCounter& other) {
+    //a key missing from one counter may have been counted up to that counter's least count before being evicted
+    const uint64_t thisBound { untrackedCountBound() }, otherBound { other.untrackedCountBound() };
+    std::unordered_map<uint64_t, Entry> combined;
+    combined.reserve(entries.size() + other.entries.size());
+    for (const Entry& entry : entries) 
+        combined.emplace(entry.key, Entry { entry.key, entry.count + otherBound, entry.error + otherBound });
+    for (const Entry& entry : other.entries) {
+        const auto [it, inserted] { combined.try_emplace(entry.key, Entry { entry.key, entry.count + thisBound, entry.error + thisBound }) };
+        if (!inserted) {
+            //undoes the bound assumed above, now that the key's count in other is known
+            it->second.count += entry.count - otherBound;
+            it->second.error += entry.error - otherBound;
+        }
+    }
+
+    entries.clear();
+    for (const auto& [key, entry] : combined) entries.push_back(entry);
+    if (entries.size() > capacity) {
+        std::nth_element(entries.begin(), entries.begin() + capacity, entries.end(), [](const Entry& a, const Entry& b){ return a.count > b.count; });
+        entries.resize(capacity);
+    }
+    std::make_heap(entries.begin(), entries.end(), [](const Entry& a, const Entry& b){ return a.count > b.count; });
+    rebuildIndex();
+}
+
+const std::vector<SpaceSavingCounter::Entry>& SpaceSavingCounter::viewEntries(void) const {
+    return entries;
+}
+
+uint64_t SpaceSavingCounter::untrackedCountBound(void) const {
+    return entries.size() < capacity ? 0 : entries[0].count;
+}
+
+void SpaceSavingCounter::siftUp(size_t i) {
+    while (i && entries[(i - 1) / 2].count > entries[i].count) {
+        swapEntries(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+void SpaceSavingCounter::siftDown(size_t i) {
+    for (;;) {
+        size_t least { i };
+        for (const size_t child : { 2 * i + 1, 2 * i + 2 }) 
+            if (child < entries.size() && entries[child].count < entries[least].count) least = child;
+        if (least == i) return;
+        swapEntries(i, least);
+        i = least;
+    }
+}
+
+void SpaceSavingCounter::swapEntries(const size_t a, const size_t b) {
+    std::swap(entries[a], entries[b]);
+    std::swap(slotOfEntry[a], slotOfEntry[b]);
+    index[slotOfEntry[a]] = a + 1;
+    index[slotOfEntry[b]] = b + 1;
+}
+
+size_t SpaceSavingCounter::homeSlot(const uint64_t key) const {
+    //Fibonacci hashing spreads keys sharing low bits, such as primes, across the table
+    return (key * 0x9E3779B97F4A7C15ull) >> (64 - std::countr_zero(index.size()));
+}
+
+size_t SpaceSavingCounter::findSlot(const uint64_t key) const {
+    const size_t mask { index.size() - 1 };
+    size_t slot { homeSlot(key) };
+    while (index[slot] && entries[index[slot] - 1].key != key) slot = (slot + 1) & mask;
+    return slot;
+}
+
+void SpaceSavingCounter::insertIntoIndex(const uint64_t key, const size_t entry) {
+    const size_t slot { findSlot(key) };
+    index[slot] = entry + 1;
+    slotOfEntry[entry] = slot;
+}
+
+void SpaceSavingCounter::eraseFromIndex(const uint64_t key) {
+    const size_t mask { index.size() - 1 };
+    size_t hole { findSlot(key) };
+    index[hole] = 0;
+    //backward shift deletion: later entries of the probe run move into the hole if their home slot does not lie between it and them
+    for (size_t slot { (hole + 1) & mask }; index[slot]; slot = (slot + 1) & mask) {
+        const size_t home { homeSlot(entries[index[slot] - 1].key) };
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            index[hole] = index[slot];
+            slotOfEntry[index[hole] - 1] = hole;
+            index[slot] = 0;
+            hole = slot;
+        }
+    }
+}
+
+void SpaceSavingCounter::rebuildIndex(void) {
+    std::fill(index.begin(), index.end(), 0);
+    slotOfEntry.assign(entries.size(), 0);
+    for (size_t i { 0 }; i < entries.size(); ++i) insertIntoIndex(entries[i].key, i);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//bounded memory approximate counter for the most frequent keys of a stream (Metwally et al.'s Space-Saving)
+//tracks at most capacity keys; when a new key arrives while full, it replaces the least counted key and inherits its count as error
+//every key counted more than total / capacity times is guaranteed to be tracked, and each tracked key's true count lies in [count - error, count]
+class SpaceSavingCounter {
+public:
+    struct Entry {
+        uint64_t key, count, error;
+    };
+
+    SpaceSavingCounter(const size_t capacity_);
+
+    void add(const uint64_t key, const uint64_t amount);
+    //combines other's counts into this one, as if their streams had been counted together, keeping the error bounds valid
+    //precondition: other has the same capacity
+    void merge(const SpaceSavingCounter& other);
+
+    //tracked entries, in no particular order
+    const std::vector<Entry>& viewEntries(void) const;
+
+private:
+    //0 if key is not tracked and the counter is not yet full, as no key could have been evicted
+    uint64_t untrackedCountBound(void) const;
+
+    //entries are a min heap by count, so the eviction candidate is always entries[0]
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    void swapEntries(const size_t a, const size_t b);
+
+    //open addressed (linear probing) index from key to position in entries
+    size_t homeSlot(const uint64_t key) const;
+    size_t findSlot(const uint64_t key) const;
+    void insertIntoIndex(const uint64_t key, const size_t entry);
+    void eraseFromIndex(const uint64_t key);
+    void rebuildIndex(void);
+
+    size_t capacity;
+    std::vector<Entry> entries;
+    //entry position + 1 per slot, 0 if the slot is empty; kept at most half full
+    std::vector<uint32_t> index;
+    //each entry's slot in index, parallel to entries
+    std::vector<uint32_t> slotOfEntry;
+};
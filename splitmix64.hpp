@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+//small, fast generator satisfying std::uniform_random_bit_generator
+//splittable: split(k) derives the kth child stream, which is independent of how (or on which thread) other children are consumed,
+//making multithreaded runs reproducible from a single seed
+class SplitMix64 {
+public:
+    using result_type = uint64_t;
+
+    explicit SplitMix64(const uint64_t seed) : state(seed) {}
+
+    result_type operator()() { return mix(state += gamma); }
+
+    //seeds the child from the kth output of this stream, without advancing it
+    SplitMix64 split(const uint64_t k) const { return SplitMix64(mix(state + (k + 1) * gamma)); }
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+private:
+    static constexpr uint64_t gamma = 0x9e3779b97f4a7c15;
+
+    static constexpr uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t state;
+};
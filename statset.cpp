@@ -7,23 +7,28 @@ StatSet::StatSet(const size_t inputCount_) :
     fastest(scale), 
     slowest(scale),
     mostFactors(scale), 
-    mostUniqueFactors(scale) {
-    timesData.reserve(inputCount);
-}
+    mostUniqueFactors(scale), 
+    fastestCounted(scale), 
+    slowestCounted(scale)
+    #ifdef COUNT_OPERATIONS
+    , mostOperations(scale)
+    , slowestOperations(scale)
+    #endif
+    {}
 
 
 void StatSet::printout(FILE* outStream) const {
     printDivider("Fastest Factorizations Attempted", "Slowest Factorizations Attempted", outStream);
-    printRecordLists<fastestComparator, slowestComparator>(fastest, slowest, outStream);
+    printRecordLists(fastest, slowest, outStream);
     
     printDivider("Factorizations With Most Total Factors", "Factorizations With Most Unique Factors", outStream);
-    printRecordLists<totalFactorsComparator, uniqueFactorsComparator>(mostFactors, mostUniqueFactors, 
-        [](const RankingList<totalFactorsComparator>::container_t::const_iterator& leftIt ){ return std::format("{} | {}", leftIt->factorization.getFactorCount(), leftIt->calcTime); },
-        [](const RankingList<uniqueFactorsComparator>::container_t::const_iterator& rightIt){ return std::format("{} | {}", rightIt->factorization.getUniqueFactorCount(), rightIt->calcTime); }, outStream);
+    printRecordLists(mostFactors, mostUniqueFactors, 
+        [](const RankingList<totalFactorsComparator>::const_iterator& leftIt ){ return std::format("{} | {}", leftIt->factorCount, leftIt->formatCalcTime()); },
+        [](const RankingList<uniqueFactorsComparator>::const_iterator& rightIt){ return std::format("{} | {}", rightIt->uniqueFactorCount, rightIt->formatCalcTime()); }, outStream);
 
     printDivider("Calculation Times", outStream);
     std::println(outStream, "{:{}}{}", 
-        std::format("{}{}", "Q0: ", inputCount ? timesData.front() : std::chrono::duration<long double, std::milli>(0)), miniPanelWidth, 
+        std::format("{}{}", "Q0: ", nanosToMillis(times.getMin())), miniPanelWidth, 
         std::format("{}{}", "Harmonic Mean:      ", harmonMean));
     std::println(outStream, "{:{}}{}", 
         std::format("{}{}", "Q1: ", firstQuart), miniPanelWidth, 
@@ -35,80 +40,232 @@ void StatSet::printout(FILE* outStream) const {
         std::format("{}{}", "Q3: ", thirdQuart), miniPanelWidth, 
         std::format("{}{}", "Arithmetic Mean:    ", arithMean));
     std::println(outStream, "{:{}}{}", 
-        std::format("{}{}", "Q4: ", inputCount ? timesData.back() : std::chrono::duration<long double, std::milli>(0)), miniPanelWidth, 
+        std::format("{}{}", "Q4: ", nanosToMillis(times.getMax())), miniPanelWidth, 
         std::format("{}{}", "Standard Deviation: ", stdDev));
     
     printDivider("Counts (fastest applicable category only)", outStream);
     timeCategories.printout(outStream);
 
+    if (const uint64_t batchCount { batchMoments.getCount() }) {
+        const auto asMillis = [](const long double ms){ return std::chrono::duration<long double, std::milli>(ms); };
+        printDivider("Batch Times", outStream);
+        std::println(outStream, "{:{}}{}", std::format("Batches: {} ({:.1f} inputs each)", batchCount, static_cast<long double>(batchedInputs) / batchCount), miniPanelWidth, 
+            std::format("Mean: {} | Standard Deviation: {}", asMillis(batchMoments.arithmeticMean()), asMillis(batchMoments.standardDeviation())));
+        std::println(outStream, "Each input is given its batch's mean, so the spread of the times above is that of batches rather than inputs");
+    }
+
+    if (countedInputs) {
+        printDivider("Hardware Counters (means per factorization)", outStream);
+        std::println(outStream, "{:{}}{}", std::format("All: {} counted", countedInputs), miniPanelWidth, formatHardwareCounts(hardwareCounts, countedInputs));
+        std::println(outStream, "{:{}}{:.0f} cycles, {}", "", miniPanelWidth, static_cast<long double>(hardwareCounts.cycles) / countedInputs, 
+            PerfCounters::isEventAvailable(PerfCounters::INSTRUCTIONS) ? std::format("{:.0f} instructions", static_cast<long double>(hardwareCounts.instructions) / countedInputs) : "n/a instructions");
+        timeCategories.printHardwareCounts(outStream);
+        std::println(outStream);
+        const auto formatEntry = [](const HardwareCountedRecord& entry) { return std::format("{} | {}", entry.formatCalcTime(), formatHardwareCounts(entry.hardwareCounts)); };
+        printRecordLists(fastestCounted, slowestCounted, 
+            [&](const RankingList<fastestComparator, HardwareCountedRecord>::const_iterator& leftIt){ return formatEntry(*leftIt); },
+            [&](const RankingList<slowestComparator, HardwareCountedRecord>::const_iterator& rightIt){ return formatEntry(*rightIt); }, outStream);
+    }
+
+    if (const uint64_t cachedInputs { cacheMisses + memoryHits + storeHits }) {
+        printDivider("Factorization Cache", outStream);
+        std::println(outStream, "{:{}}{}", std::format("Hits: {} ({:.1f}%)", memoryHits + storeHits, 100.L * (memoryHits + storeHits) / cachedInputs), miniPanelWidth, 
+            std::format("In Memory: {} | From Disk: {} | Misses: {}", memoryHits, storeHits, cacheMisses));
+        std::println(outStream, "Hits are not timed, so calculation times above cover misses only");
+    }
+
+    #ifdef COUNT_OPERATIONS
+    if (operationCountedInputs) {
+        printDivider("Operation Counts (means per factorization)", outStream);
+        const auto perInput = [&](const uint64_t count) { return static_cast<long double>(count) / operationCountedInputs; };
+        std::println(outStream, "{:{}}{:.1f} trial divisions, {:.2f} primality tests, {:.1f} modular multiplications", 
+            std::format("All: {} counted", operationCountedInputs), miniPanelWidth, 
+            perInput(operationCounts.trialDivisions), perInput(operationCounts.primalityTests), perInput(operationCounts.modularMultiplications));
+        //stage times are shares of the time spent within primeFactorization, which the instrumentation itself inflates somewhat
+        const uint64_t totalTicks { std::max(operationCounts.getTotalTicks(), uint64_t { 1 }) };
+        for (int stage { 0 }; stage < OperationCounts::stageCount; ++stage) {
+            const uint64_t ticks { operationCounts.stageTicks[stage] };
+            std::print(outStream, "{:{}}", std::format("{}: {:.0f}ns ({:.1f}%)", OperationCounts::getStageName(static_cast<OperationCounts::Stage>(stage)), 
+                TscClock::ticksToNanos(ticks) / operationCountedInputs, 100.L * ticks / totalTicks), miniPanelWidth);
+            if (stage % 2) std::println(outStream);
+        }
+        std::println(outStream);
+
+        printDivider("Slowest Factorizations Attempted", "Factorizations With Most Operations", outStream);
+        const auto formatEntry = [](const OperationCountedRecord& entry) { return std::format("{} | {}", entry.formatCalcTime(), formatOperationCounts(entry.operationCounts)); };
+        printRecordLists(slowestOperations, mostOperations, 
+            [&](const RankingList<slowestComparator, OperationCountedRecord>::const_iterator& leftIt){ return formatEntry(*leftIt); },
+            [&](const RankingList<mostOperationsComparator, OperationCountedRecord>::const_iterator& rightIt){ return formatEntry(*rightIt); }, outStream);
+    }
+    #endif
+
     printDivider("Most Common Prime Factors", outStream);
     int unreadyForNewline = 0;
-    for (const auto& [count, base] : mostCommonFactors) {
-        std::print(outStream, "{:{}}", std::format("{}: {}", base, count), miniPanelWidth / 3);
+    //counts of large primes are lower bounds unless exact
+    for (const auto& [base, count, exact] : mostCommonFactors) {
+        std::print(outStream, "{:{}}", std::format("{}: {}{}", base, exact ? "" : "≥", count), miniPanelWidth / 3);
         if (!(++unreadyForNewline %= 12)) std::println(outStream);
     }
     std::println(outStream);
 }
 
 void StatSet::handleNewFactorizationData(const FactorCalculationInfo& newFactorization) {
-    fastest.rankIfApplicable(newFactorization);
-    slowest.rankIfApplicable(newFactorization);
-    mostFactors.rankIfApplicable(newFactorization);
-    mostUniqueFactors.rankIfApplicable(newFactorization);
+    //the factorization itself is only read here, by the factor counts; every ranking keeps a compact record
+    const FactorRecord record(newFactorization);
+    mostFactors.rankIfApplicable(record);
+    mostUniqueFactors.rankIfApplicable(record);
   
     addFactorsToCount(newFactorization.factorization);
 
-    timesData.push_back(newFactorization.calcTime);
+    switch (newFactorization.cacheResult) {
+    case CacheResult::MISS:
+        ++cacheMisses;
+        break;
+    case CacheResult::MEMORY_HIT:
+        ++memoryHits;
+        break;
+    case CacheResult::STORE_HIT:
+        ++storeHits;
+        break;
+    case CacheResult::UNCACHED:
+        break;
+    }
+
+    #ifdef COUNT_OPERATIONS
+    //counted whether or not timed, as the counts of an input do not depend on its timing,
+    //but not for cache hits, which did no operations and would dilute the means as they would the time statistics
+    const OperationCountedRecord operationRecord(newFactorization);
+    if (!newFactorization.isCacheHit()) {
+        mostOperations.rankIfApplicable(operationRecord);
+        operationCounts += newFactorization.operationCounts;
+        ++operationCountedInputs;
+    }
+    #endif
+
+    //inputs skipped by sampled timing, and cache hits, count towards everything but the time statistics
+    if (!newFactorization.isTimed()) return;
+    fastest.rankIfApplicable(record);
+    slowest.rankIfApplicable(record);
+    #ifdef COUNT_OPERATIONS
+    slowestOperations.rankIfApplicable(operationRecord);
+    #endif
+
+    const long double nanos { TscClock::ticksToNanos(newFactorization.calcTicks) };
+    moments.add(nanos / 1e6L);
+    times.record(std::llround(nanos));
+
+    //only ever counted alongside being timed
+    if (!newFactorization.hardwareCounts.isCounted()) return;
+    const HardwareCountedRecord countedRecord(newFactorization);
+    fastestCounted.rankIfApplicable(countedRecord);
+    slowestCounted.rankIfApplicable(countedRecord);
+    hardwareCounts += newFactorization.hardwareCounts;
+    ++countedInputs;
+    timeCategories.addHardwareCounts(std::llround(nanos), newFactorization.hardwareCounts);
+}
+
+void StatSet::handleNewBatchData(const uint64_t batchCount, const uint64_t batchTicks) {
+    batchMoments.add(TscClock::ticksToNanos(batchTicks) / 1e6L);
+    batchedInputs += batchCount;
+}
+
+void StatSet::mergeShard(const StatSet& shard) {
+    fastest.merge(shard.fastest);
+    slowest.merge(shard.slowest);
+    mostFactors.merge(shard.mostFactors);
+    mostUniqueFactors.merge(shard.mostUniqueFactors);
+    fastestCounted.merge(shard.fastestCounted);
+    slowestCounted.merge(shard.slowestCounted);
+    #ifdef COUNT_OPERATIONS
+    mostOperations.merge(shard.mostOperations);
+    slowestOperations.merge(shard.slowestOperations);
+    operationCounts += shard.operationCounts;
+    operationCountedInputs += shard.operationCountedInputs;
+    #endif
+
+    allFactors.merge(shard.allFactors);
+
+    moments.merge(shard.moments);
+    times.merge(shard.times);
+
+    batchMoments.merge(shard.batchMoments);
+    batchedInputs += shard.batchedInputs;
+
+    hardwareCounts += shard.hardwareCounts;
+    countedInputs += shard.countedInputs;
+
+    cacheMisses += shard.cacheMisses;
+    memoryHits += shard.memoryHits;
+    storeHits += shard.storeHits;
+    timeCategories.mergeHardwareCounts(shard.timeCategories);
 }
 
 void StatSet::completeFinalCalculations(void) {
     //avoid division by 0 - leaves duration values at default constructed 0
-    if (!inputCount) return;
+    //inputs too wide to be recorded (see FactorizationCalculator::manualInputTest) are not counted
+    if (!times.getCount()) return;
 
-    std::ranges::sort(timesData, std::less());
+    firstQuart = nanosToMillis(times.valueAtQuantile(.25));
+    median =     nanosToMillis(times.valueAtQuantile(.5));
+    thirdQuart = nanosToMillis(times.valueAtQuantile(.75));
+    iqMean =     nanosToMillis(times.meanBetweenQuantiles(.25, .75));
 
-    firstQuart = interpolateDataAtPercentile<std::chrono::duration<long double, std::milli>>(timesData, .25);
-    median =     interpolateDataAtPercentile<std::chrono::duration<long double, std::milli>>(timesData, .5);
-    thirdQuart = interpolateDataAtPercentile<std::chrono::duration<long double, std::milli>>(timesData, .75);
+    arithMean =  std::chrono::duration<long double, std::milli>(moments.arithmeticMean());
+    harmonMean = std::chrono::duration<long double, std::milli>(moments.harmonicMean());
+    geoMean =    std::chrono::duration<long double, std::milli>(moments.geometricMean());
+    stdDev =     std::chrono::duration<long double, std::milli>(moments.standardDeviation());
 
-    //because the edge elements of the inner quartiles may have unique weights compared to the other elements, they are handled separately
-    std::chrono::duration<long double, std::milli> interQuartileSum = 
-        (.25 * (timesData.size() % 4)) *    //<-- quartile edge elements weight follows this expr
-        (timesData[timesData.size() / 4] +  //lower quartile edge element
-        timesData[timesData.size() - 1 - (timesData.size() / 4)]); //upper quartile edge element
+    timeCategories.tally(times);
 
-    //calculated ahead due to use in stdDev calculation 
-    arithMean = std::reduce(std::next(timesData.begin()), timesData.end(), timesData.front()) / inputCount;
-    
-    std::chrono::duration<long double, std::milli> sumReciprocals(0), sumLogs(0), sumSquaredDeviations(0);
-    for (const std::chrono::duration<long double, std::milli> time : timesData) {
-        timeCategories.incrementAppropriateCategory(time.count()); 
+    fastest.sortRanks();
+    slowest.sortRanks();
+    mostFactors.sortRanks();
+    mostUniqueFactors.sortRanks();
+    fastestCounted.sortRanks();
+    slowestCounted.sortRanks();
+    #ifdef COUNT_OPERATIONS
+    mostOperations.sortRanks();
+    slowestOperations.sortRanks();
+    #endif
 
-        sumReciprocals       += std::chrono::duration<long double, std::milli>(1. / time.count());
-        sumLogs              += std::chrono::duration<long double, std::milli>(logl(time.count()));
-        sumSquaredDeviations += std::chrono::duration<long double, std::milli>(powl(time.count() - arithMean.count(), 2));
+    mostCommonFactors = allFactors.mostCommon(scale * 12);
+}
 
-        if (time.count() > firstQuart.count() && time.count() < thirdQuart.count()) interQuartileSum += time;
+LiveSummary StatSet::getLiveSummary(void) const {
+    LiveSummary summary { moments };
+    if (const FactorRecord* slowestItem { slowest.viewBest() }) {
+        summary.slowestN = slowestItem->n;
+        summary.slowestTime = slowestItem->getCalcTime();
     }
-    harmonMean = std::chrono::duration<long double, std::milli>(1. / (sumReciprocals / inputCount).count());
-    geoMean =    std::chrono::duration<long double, std::milli>(expl(sumLogs.count() / inputCount));
-    iqMean =     std::chrono::duration<long double, std::milli>(interQuartileSum * 2. / inputCount);
-    stdDev =     std::chrono::duration<long double, std::milli>(sqrtl(sumSquaredDeviations.count() / inputCount));
-
-    for (const auto& [base, exp] : allFactors) {
-        mostCommonFactors.emplace(exp, base);
-        if (mostCommonFactors.size() > scale * 12) 
-            mostCommonFactors.erase(std::prev(mostCommonFactors.end()));
+    return summary;
+}
+
+LiveSnapshot StatSet::getLiveSnapshot(void) const {
+    return { moments, times, slowest };
+}
+
+uint64_t StatSet::getTimedCount(void) const {
+    return times.getCount();
+}
+
+void LiveSummary::merge(const LiveSummary& other) {
+    moments.merge(other.moments);
+    if (other.slowestTime > slowestTime) {
+        slowestN = other.slowestN;
+        slowestTime = other.slowestTime;
     }
 }
 
-const size_t StatSet::getMaxValidInputCount(void) const {
-    return timesData.max_size();
+std::string formatLiveSummary(const LiveSummary& summary, const uint64_t completed, const uint64_t total, const std::chrono::duration<long double> elapsed) {
+    const auto asMillis = [](const long double ms){ return std::chrono::duration<long double, std::milli>(ms); };
+    return std::format("{} | {:.0f}/sec | Harmonic {}, Geometric {}, Arithmetic {}, σ {} | Slowest: {} ({})", 
+        total ? std::format("{}%", 100 * completed / total) : std::format("{} done", completed), elapsed.count() ? completed / elapsed.count() : 0.L, 
+        asMillis(summary.moments.harmonicMean()), asMillis(summary.moments.geometricMean()), 
+        asMillis(summary.moments.arithmeticMean()), asMillis(summary.moments.standardDeviation()), 
+        summary.slowestN, summary.slowestTime);
 }
 
 void StatSet::addFactorsToCount(const Factorization& newFactorization) {
-    for (const auto& newFactor : newFactorization.viewFactors()) 
-        allFactors[newFactor.base] += newFactor.exp;
-
-    
+    for (const auto& newFactor : newFactorization.viewFactors())
+        allFactors.add(newFactor.base, newFactor.exp);
 }
@@ -7,23 +7,56 @@
 #include <numeric>
 #include <string>
 #include <format>
+#include <limits>
 #include <print>
-#include <map>
 #include <vector>
 #include "calculationinfo.hpp"
+#include "factorcounter.hpp"
+#include "latencyhistogram.hpp"
+#include "opcounter.hpp"
+#include "perfcounters.hpp"
 #include "rankinglist.hpp"
+#include "runningmoments.hpp"
 #include "timecategories.hpp"
 #include "utils.hpp"
 
+//figures kept up to date as each factorization is recorded, so they can be reported while a run is still in progress
+struct LiveSummary {
+    //calcTimes in milliseconds
+    RunningMoments moments;
+    uint64_t slowestN { 0 };
+    std::chrono::duration<long double, std::milli> slowestTime { 0 };
+
+    void merge(const LiveSummary& other);
+};
+
+//the parts of a shard that TelemetryServer reports, copied out whole so that they can be published through a SeqLock
+struct LiveSnapshot {
+    //calcTimes in milliseconds
+    RunningMoments moments;
+    LatencyHistogram times;
+    RankingList<slowestComparator> slowest { RankingList<slowestComparator>::maxCapacity };
+};
+
 //collection of statistics tracked as primes factorizations are calculated
 class StatSet {
 public:
     StatSet(const size_t inputCount_);
     void printout(FILE* outStream = stdout) const;
     void handleNewFactorizationData(const FactorCalculationInfo& newFactorization);
+    //records the time of batchCount inputs timed together (e.g. a block), each of which is also recorded individually with the batch's mean
+    void handleNewBatchData(const uint64_t batchCount, const uint64_t batchTicks);
+    //combines the data of another shard into this one
+    //precondition: neither this nor shard has had completeFinalCalculations called
+    void mergeShard(const StatSet& shard);
     void completeFinalCalculations(void);
+    LiveSummary getLiveSummary(void) const;
+    LiveSnapshot getLiveSnapshot(void) const;
+    //inputs whose times were measured, i.e. all but those skipped by sampled timing
+    uint64_t getTimedCount(void) const;
 
-    const size_t getMaxValidInputCount(void) const;
+    //calculation times are kept in a fixed size histogram, so no input count is too large to be recorded
+    static constexpr size_t getMaxValidInputCount(void) { return std::numeric_limits<size_t>::max(); }
 
     void addFactorsToCount(const Factorization& newFactorization);
 
@@ -36,6 +69,13 @@ private:
     RankingList<slowestComparator> slowest;
     RankingList<totalFactorsComparator> mostFactors;
     RankingList<uniqueFactorsComparator> mostUniqueFactors;
+    //the same rankings of counted inputs only, kept with their counts for the hardware counter printout
+    RankingList<fastestComparator, HardwareCountedRecord> fastestCounted;
+    RankingList<slowestComparator, HardwareCountedRecord> slowestCounted;
+    #ifdef COUNT_OPERATIONS
+    RankingList<mostOperationsComparator, OperationCountedRecord> mostOperations;
+    RankingList<slowestComparator, OperationCountedRecord> slowestOperations;
+    #endif
 
     //statistical facts
     std::chrono::duration<long double, std::milli> firstQuart, median, thirdQuart;
@@ -45,27 +85,38 @@ private:
     TimeCategories timeCategories;
 
     //collection of all factors found, as if product of all inputs was factorized
-    //Factorization class not used due to the need for frequent internal insertion and benefits of sorting gurantees
-    //additionally because addition of exponents can result in exp exceeding 8 bits
-    std::map<Factorization::base_t, unsigned int> allFactors;
-    //flipped version that allFactors values will eventually be transferred to to filter out least common factors
-    std::multimap<decltype(allFactors)::mapped_type, decltype(allFactors)::key_type, std::greater<>> mostCommonFactors;
+    FactorCounter allFactors;
+    //the most common of allFactors, filled in by completeFinalCalculations
+    std::vector<FactorCounter::FactorCount> mostCommonFactors;
 
-    //vector of each individual calculation time
-    std::vector<std::chrono::duration<long double, std::milli>> timesData;
+    //means and standard deviation of the calculation times, updated per factorization
+    RunningMoments moments;
+    //every individual calculation time, to within LatencyHistogram's bucket resolution
+    LatencyHistogram times;
 
-};
+    //whole batch times in milliseconds, where inputs are timed a batch at a time
+    RunningMoments batchMoments;
+    uint64_t batchedInputs { 0 };
+
+    //sums of the hardware event counts of every counted input, see FactorizationCalculator's collectHardwareCounters
+    HardwareCounts hardwareCounts;
+    uint64_t countedInputs { 0 };
 
+    //outcomes of inputs factored with a FactorCache, see CacheResult
+    uint64_t cacheMisses { 0 }, memoryHits { 0 }, storeHits { 0 };
 
-//takes a target fractional percentile (0-1) and calculates a weighted average from the closest elements to that target
-template<class T>
-inline T interpolateDataAtPercentile(const std::vector<T>& sortedList, const double fractionalPercentile) {
-    //prevents attempts to access 2 distinctly indexed elements nearest to a target when 2 such elements do not exist 
-    if (sortedList.size() < 2) 
-        return sortedList.empty() ? T(0) : sortedList.front();
-    else {
-        const double pos = (sortedList.size() - 1) * fractionalPercentile;
-        const auto pFirst = sortedList.cbegin() + static_cast<size_t>(pos);
-        return (*pFirst) + ((pos - floor(pos)) * ((*std::next(pFirst)) - (*pFirst)));
-    } 
+    #ifdef COUNT_OPERATIONS
+    //sums of the operation counts of every input, timed or not
+    OperationCounts operationCounts;
+    uint64_t operationCountedInputs { 0 };
+    #endif
+};
+
+//converts the histogram's nanosecond values to the millisecond durations reported everywhere else
+inline std::chrono::duration<long double, std::milli> nanosToMillis(const long double ns) {
+    return std::chrono::duration<long double, std::nano>(ns);
 }
+
+//e.g. "42% | 1234567/sec | Harmonic 0.0012ms, Geometric 0.0015ms, Arithmetic 0.0021ms, σ 0.0100ms | Slowest: 18446744073709551557 (3.2ms)"
+//total is 0 if unknown, in which case the count completed is shown instead of a percentage
+std::string formatLiveSummary(const LiveSummary& summary, const uint64_t completed, const uint64_t total, const std::chrono::duration<long double> elapsed);
@@ -0,0 +1,263 @@
+#include "telemetry.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//how often the server thread checks whether it has been asked to stop while no request is waiting
+static constexpr int stopPollMilliseconds = 200;
+//quantiles reported alongside the histogram
+static constexpr double reportedQuantiles[] { .5, .9, .99, .999 };
+//histogram buckets reported at each power of two nanoseconds in this range, which are bucket boundaries of LatencyHistogram
+static constexpr unsigned minReportedBucketBits = 7, maxReportedBucketBits = LatencyHistogram::maxTrackableBits - 1;
+
+TelemetryServer::TelemetryServer(const uint16_t port_, const std::string& socketPath_, const unsigned threadCount_, const uint64_t total_) :
+    threadCount(threadCount_),
+    total(total_),
+    start(std::chrono::steady_clock::now()),
+    slots(std::make_unique<WorkerSlot[]>(threadCount_)),
+    port(port_),
+    socketPath(socketPath_),
+    listener(-1) {
+    const auto fail = [&](const std::string_view step) {
+        const std::string reason { std::format("cannot {} telemetry endpoint {} ({})", step, describeEndpoint(), std::strerror(errno)) };
+        if (listener >= 0) close(listener);
+        throw std::runtime_error(reason);
+    };
+
+    if (socketPath.empty()) {
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listener < 0) fail("open");
+        const int reuse { 1 };
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        //loopback only, as the statistics are for the local user rather than the network
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address))) fail("bind");
+    }
+    else {
+        sockaddr_un address {};
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            errno = ENAMETOOLONG;
+            fail("bind");
+        }
+        //a socket file left behind by an earlier run would otherwise fail the bind, but anything else at the path is left alone
+        struct stat existing;
+        const bool exists { !lstat(socketPath.c_str(), &existing) };
+        if (exists && !S_ISSOCK(existing.st_mode))
+            throw std::runtime_error(std::format("cannot bind telemetry endpoint {} ({} exists and is not a socket)", describeEndpoint(), socketPath));
+        if (exists) unlink(socketPath.c_str());
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listener < 0) fail("open");
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address))) fail("bind");
+    }
+    if (listen(listener, SOMAXCONN)) fail("listen on");
+
+    server = std::jthread([this](const std::stop_token stop){ serve(stop); });
+}
+
+TelemetryServer::~TelemetryServer() {
+    server.request_stop();
+    server.join();
+    close(listener);
+    if (!socketPath.empty()) unlink(socketPath.c_str());
+}
+
+void TelemetryServer::publish(const unsigned worker, const uint64_t count, const StatSet& shard) {
+    WorkerSlot& slot { slots[worker] };
+    //only this worker writes its count, so no read-modify-write is needed
+    slot.completed.store(slot.completed.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    const auto now { std::chrono::steady_clock::now() };
+    if (now - slot.lastPublished < publishInterval) return;
+    slot.snapshot.store(shard.getLiveSnapshot());
+    slot.lastPublished = now;
+}
+
+void TelemetryServer::publishAll(const std::vector<StatSet>& shards) {
+    for (unsigned i { 0 }; i < threadCount && i < shards.size(); ++i) {
+        slots[i].snapshot.store(shards[i].getLiveSnapshot());
+        slots[i].lastPublished = std::chrono::steady_clock::now();
+    }
+}
+
+void TelemetryServer::setTotal(const uint64_t total_) {
+    total.store(total_, std::memory_order_relaxed);
+}
+
+std::string TelemetryServer::describeEndpoint(void) const {
+    return socketPath.empty() ? std::format("http://127.0.0.1:{}/metrics", port) : std::format("unix:{}", socketPath);
+}
+
+void TelemetryServer::serve(const std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        pollfd waiting { listener, POLLIN, 0 };
+        if (poll(&waiting, 1, stopPollMilliseconds) <= 0) continue;
+        const int client { accept4(listener, nullptr, nullptr, SOCK_CLOEXEC) };
+        if (client < 0) continue;
+        respond(client);
+        close(client);
+    }
+}
+
+void TelemetryServer::respond(const int client) const {
+    //a client that connects and sends nothing is dropped rather than holding up every later scrape
+    const timeval timeout { 1, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    //only the request line matters, and every request is answered and closed, so the rest of the headers are not awaited
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+        const ssize_t received { recv(client, buffer, sizeof(buffer), 0) };
+        if (received <= 0) break;
+        request.append(buffer, received);
+    }
+    //e.g. "GET /metrics HTTP/1.1"
+    const size_t pathStart { request.find(' ') + 1 }, pathEnd { request.find_first_of(" ?\r\n", pathStart) };
+    const std::string_view method { std::string_view(request).substr(0, pathStart ? pathStart - 1 : 0) };
+    const std::string_view path { pathStart && pathEnd != std::string::npos ? std::string_view(request).substr(pathStart, pathEnd - pathStart) : "" };
+
+    std::string_view status { "200 OK" }, contentType;
+    std::string body;
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+        contentType = "text/plain";
+        body = "only GET is supported\n";
+    }
+    else if (path == "/metrics") {
+        contentType = "text/plain; version=0.0.4";
+        body = formatPrometheus(takeSnapshot());
+    }
+    else if (path == "/metrics.json" || path == "/") {
+        contentType = "application/json";
+        body = formatJson(takeSnapshot());
+    }
+    else {
+        status = "404 Not Found";
+        contentType = "text/plain";
+        body = "available: /metrics (prometheus), /metrics.json\n";
+    }
+
+    const std::string response { std::format("HTTP/1.1 {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}", status, contentType, body.size(), body) };
+    for (size_t sent { 0 }; sent < response.size(); ) {
+        const ssize_t written { send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL) };
+        if (written <= 0) return;
+        sent += written;
+    }
+}
+
+TelemetryServer::Snapshot TelemetryServer::takeSnapshot(void) const {
+    Snapshot snapshot { std::chrono::steady_clock::now() - start, 0, total.load(std::memory_order_relaxed), {}, {} };
+    for (unsigned i { 0 }; i < threadCount; ++i) {
+        snapshot.threadCompleted.push_back(slots[i].completed.load(std::memory_order_relaxed));
+        snapshot.completed += snapshot.threadCompleted.back();
+        const LiveSnapshot stats { slots[i].snapshot.load() };
+        snapshot.stats.moments.merge(stats.moments);
+        snapshot.stats.times.merge(stats.times);
+        snapshot.stats.slowest.merge(stats.slowest);
+    }
+    snapshot.stats.slowest.sortRanks();
+    return snapshot;
+}
+
+static long double throughput(const uint64_t completed, const std::chrono::duration<long double> elapsed) {
+    return elapsed.count() > 0 ? completed / elapsed.count() : 0.L;
+}
+
+//NaN while it cannot be estimated, e.g. for a run whose total is unknown
+static long double eta(const uint64_t completed, const uint64_t total, const std::chrono::duration<long double> elapsed) {
+    if (!total || !completed) return NAN;
+    return completed >= total ? 0.L : elapsed.count() * (total - completed) / completed;
+}
+
+std::string TelemetryServer::formatPrometheus(const Snapshot& snapshot) const {
+    std::string text;
+    const auto metric = [&](const std::string_view name, const std::string_view type, const std::string_view help) {
+        text += std::format("# HELP primefactor_{} {}\n# TYPE primefactor_{} {}\n", name, help, name, type);
+    };
+    const LatencyHistogram& times { snapshot.stats.times };
+
+    metric("inputs_completed", "counter", "Inputs factored so far.");
+    text += std::format("primefactor_inputs_completed {}\n", snapshot.completed);
+    metric("inputs_total", "gauge", "Inputs in the run, or 0 while unknown.");
+    text += std::format("primefactor_inputs_total {}\n", snapshot.total);
+    metric("elapsed_seconds", "gauge", "Time since the run started.");
+    text += std::format("primefactor_elapsed_seconds {:.3f}\n", snapshot.elapsed.count());
+    metric("throughput_inputs_per_second", "gauge", "Mean rate since the run started.");
+    text += std::format("primefactor_throughput_inputs_per_second {:.1f}\n", throughput(snapshot.completed, snapshot.elapsed));
+    metric("eta_seconds", "gauge", "Time remaining at the mean rate so far, or NaN while the total is unknown.");
+    //prometheus spells it NaN, where std::format gives nan
+    const long double remaining { eta(snapshot.completed, snapshot.total, snapshot.elapsed) };
+    text += std::format("primefactor_eta_seconds {}\n", std::isnan(remaining) ? "NaN" : std::format("{:.3f}", remaining));
+
+    //timed inputs only, as published at most publishInterval ago, so the count may trail inputs_completed
+    metric("calc_time_seconds", "histogram", "Calculation times of timed inputs.");
+    for (unsigned bits { minReportedBucketBits }; bits <= maxReportedBucketBits; ++bits) {
+        const uint64_t bound { uint64_t { 1 } << bits };
+        text += std::format("primefactor_calc_time_seconds_bucket{{le=\"{}\"}} {}\n", bound / 1e9, times.countBelow(bound));
+    }
+    text += std::format("primefactor_calc_time_seconds_bucket{{le=\"+Inf\"}} {}\n", times.getCount());
+    text += std::format("primefactor_calc_time_seconds_sum {:.9f}\n", snapshot.stats.moments.arithmeticMean() * snapshot.stats.moments.getCount() / 1e3L);
+    text += std::format("primefactor_calc_time_seconds_count {}\n", times.getCount());
+    metric("calc_time_quantile_seconds", "gauge", "Estimated quantiles of the calculation times.");
+    for (const double q : reportedQuantiles)
+        text += std::format("primefactor_calc_time_quantile_seconds{{quantile=\"{}\"}} {:.9f}\n", q, times.getCount() ? times.valueAtQuantile(q) / 1e9L : 0.L);
+
+    metric("slowest_seconds", "gauge", "Slowest inputs so far, by rank.");
+    unsigned rank { 1 };
+    for (auto it { snapshot.stats.slowest.cbegin() }; it != snapshot.stats.slowest.cend(); ++it, ++rank)
+        text += std::format("primefactor_slowest_seconds{{rank=\"{}\",n=\"{}\"}} {:.9f}\n", rank, it->n, it->getCalcTime().count() / 1e3L);
+
+    metric("thread_inputs_completed", "counter", "Inputs factored so far by each thread.");
+    for (size_t i { 0 }; i < snapshot.threadCompleted.size(); ++i)
+        text += std::format("primefactor_thread_inputs_completed{{thread=\"{}\"}} {}\n", i, snapshot.threadCompleted[i]);
+    metric("thread_throughput_inputs_per_second", "gauge", "Mean rate of each thread since the run started.");
+    for (size_t i { 0 }; i < snapshot.threadCompleted.size(); ++i)
+        text += std::format("primefactor_thread_throughput_inputs_per_second{{thread=\"{}\"}} {:.1f}\n", i, throughput(snapshot.threadCompleted[i], snapshot.elapsed));
+    return text;
+}
+
+std::string TelemetryServer::formatJson(const Snapshot& snapshot) const {
+    //JSON has no NaN, so unknown figures are null
+    const auto number = [](const long double value) { return std::isnan(value) ? std::string("null") : std::format("{:.6f}", value); };
+    const LatencyHistogram& times { snapshot.stats.times };
+    const RunningMoments& moments { snapshot.stats.moments };
+
+    std::string text { std::format("{{\"elapsedSeconds\":{},\"completed\":{},\"total\":{},\"throughputPerSecond\":{},\"etaSeconds\":{},",
+        number(snapshot.elapsed.count()), snapshot.completed, snapshot.total ? std::format("{}", snapshot.total) : "null",
+        number(throughput(snapshot.completed, snapshot.elapsed)), number(eta(snapshot.completed, snapshot.total, snapshot.elapsed))) };
+
+    text += std::format("\"calcTimes\":{{\"timed\":{},\"meanMs\":{},\"stdDevMs\":{},\"minNs\":{},\"maxNs\":{},\"quantilesNs\":{{", times.getCount(),
+        number(moments.arithmeticMean()), number(moments.standardDeviation()), times.getCount() ? times.getMin() : 0, times.getMax());
+    for (const double q : reportedQuantiles)
+        text += std::format("{}\"{}\":{}", q == reportedQuantiles[0] ? "" : ",", q, number(times.getCount() ? times.valueAtQuantile(q) : 0.L));
+    //cumulative, as in the prometheus histogram
+    text += "},\"histogram\":[";
+    for (unsigned bits { minReportedBucketBits }; bits <= maxReportedBucketBits; ++bits)
+        text += std::format("{}{{\"belowNs\":{},\"count\":{}}}", bits == minReportedBucketBits ? "" : ",", uint64_t { 1 } << bits, times.countBelow(uint64_t { 1 } << bits));
+    text += "]},\"slowest\":[";
+
+    //n is a string, as JSON numbers beyond 2^53 lose precision in most parsers
+    for (auto it { snapshot.stats.slowest.cbegin() }; it != snapshot.stats.slowest.cend(); ++it)
+        text += std::format("{}{{\"n\":\"{}\",\"ms\":{},\"factorization\":\"{}\"}}", it == snapshot.stats.slowest.cbegin() ? "" : ",",
+            it->n, number(it->getCalcTime().count()), it->formatFactorization().substr(2));
+    text += "],\"threads\":[";
+    for (size_t i { 0 }; i < snapshot.threadCompleted.size(); ++i)
+        text += std::format("{}{{\"completed\":{},\"throughputPerSecond\":{}}}", i ? "," : "", snapshot.threadCompleted[i], number(throughput(snapshot.threadCompleted[i], snapshot.elapsed)));
+    text += "]}\n";
+    return text;
+}
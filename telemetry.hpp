@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+#include "seqlock.hpp"
+#include "statset.hpp"
+
+//serves the progress and statistics of a run in progress over HTTP, on a port of 127.0.0.1 or a unix domain socket
+//GET /metrics answers in prometheus text format, and GET /metrics.json (or /) in JSON, e.g.
+//  curl -s localhost:9464/metrics
+//  curl -s --unix-socket telemetry.sock localhost/metrics.json
+//workers publish into per worker slots without ever taking a lock: progress counts are relaxed atomics updated every chunk,
+//and shard snapshots go through a SeqLock at most once per publishInterval; requests are answered by a background thread
+//from whatever was last published, so a scrape never waits on or slows the factoring threads
+class TelemetryServer {
+public:
+    //listens on 127.0.0.1:port, or on socketPath (replacing any stale socket, but never any other kind of file) if it is nonempty
+    //total is the run's input count, or 0 if it is not known ahead of time
+    //throws std::runtime_error if the endpoint cannot be bound
+    TelemetryServer(const uint16_t port, const std::string& socketPath, const unsigned threadCount, const uint64_t total);
+    ~TelemetryServer();
+
+    //records that worker has completed count more inputs, and republishes its shard if the last was more than publishInterval ago
+    //precondition: only called by worker's own thread (or by any one thread while no worker is running)
+    void publish(const unsigned worker, const uint64_t count, const StatSet& shard);
+    //republishes every shard regardless of publishInterval, e.g. once a pass over the inputs has finished
+    //precondition: no worker is running
+    void publishAll(const std::vector<StatSet>& shards);
+    //e.g. once batch mode has parsed every input
+    void setTotal(const uint64_t total_);
+
+    //e.g. "http://127.0.0.1:9464/metrics" or "unix:telemetry.sock"
+    std::string describeEndpoint(void) const;
+
+    //long enough that copying a snapshot (mostly its histogram) is negligible next to a publishInterval of factoring
+    static constexpr std::chrono::milliseconds publishInterval { 250 };
+
+private:
+    //everything a scrape reports, gathered from every worker's slot
+    struct Snapshot {
+        std::chrono::duration<long double> elapsed;
+        uint64_t completed, total;
+        std::vector<uint64_t> threadCompleted;
+        LiveSnapshot stats;
+    };
+
+    //aligned to avoid false sharing between workers
+    struct alignas(64) WorkerSlot {
+        std::atomic<uint64_t> completed { 0 };
+        //only touched by the worker itself
+        std::chrono::steady_clock::time_point lastPublished;
+        SeqLock<LiveSnapshot> snapshot;
+    };
+
+    void serve(const std::stop_token stop);
+    void respond(const int client) const;
+    Snapshot takeSnapshot(void) const;
+    std::string formatPrometheus(const Snapshot& snapshot) const;
+    std::string formatJson(const Snapshot& snapshot) const;
+
+    const unsigned threadCount;
+    std::atomic<uint64_t> total;
+    const std::chrono::steady_clock::time_point start;
+    const std::unique_ptr<WorkerSlot[]> slots;
+
+    uint16_t port;
+    std::string socketPath;
+    int listener;
+    //last, so that it is joined before anything it reads is destroyed
+    std::jthread server;
+};
@@ -0,0 +1,229 @@
+#include "tieredfactorization.hpp"
+#include "opcounter.hpp"
+
+static primes::TierCrossovers tierCrossovers;
+
+void primes::setTierCrossovers(const TierCrossovers& crossovers) {
+    tierCrossovers.trialDivisionMaxBits = std::min(crossovers.trialDivisionMaxBits, TierCrossovers::maxTrialDivisionBits);
+    tierCrossovers.oneLineMaxBits = std::min(crossovers.oneLineMaxBits, TierCrossovers::maxOneLineBits);
+    tierCrossovers.squfofMaxBits = std::min(crossovers.squfofMaxBits, TierCrossovers::maxSqufofBits);
+}
+
+const primes::TierCrossovers& primes::getTierCrossovers(void) {
+    return tierCrossovers;
+}
+
+//squares are always 0, 1, 4, 9, 16, 17, 25, 33, 36, 41, 49 or 57 mod 64, which rules out 81% of non squares without a square root
+static bool isSquare(const uint64_t n, uint64_t& root) {
+    if (!((0x0202021202030213ull >> (n & 63)) & 0b1)) return false;
+    root = primes::isqrt(n);
+    return root * root == n;
+}
+
+uint64_t primes::splitCofactor(const uint64_t n) {
+    const OperationCounter::StageScope stage(OperationCounts::SPLITTING);
+    const unsigned bits { static_cast<unsigned>(std::bit_width(n)) };
+    const TrialDivisionKernel& kernel { TrialDivisionKernel::get() };
+
+    if (bits <= tierCrossovers.oneLineMaxBits) {
+        //hart's method usually succeeds within n^(1/3) iterations; lehman's is guaranteed to, but is slower on average
+        const uint64_t cubeRoot { primes::iroot(n, 3) };
+        if (const uint64_t factor { hartOneLineFactor(n, cubeRoot) }) return factor;
+        //lehman's method requires that n has no factors through its cube root
+        if (const size_t i { kernel.findDivisor(n, 0, cubeRoot) }; i < kernel.getPrimeCount()) return kernel.getPrime(i);
+        return primes::lehmanFactor(n);
+    }
+
+    if (bits <= tierCrossovers.squfofMaxBits)
+        if (const uint64_t factor { primes::squfof(n) }) return factor;
+
+    return primes::pollardBrent(n);
+}
+
+Factorization primes::tieredFactorization(uint64_t n) {
+    Factorization foundFactors;
+    //0 and 1 have no prime factorization
+    if (n < 2ull) return foundFactors;
+
+    uint_fast8_t exp { 0 };
+    {
+        const OperationCounter::StageScope stage(OperationCounts::POWERS_OF_TWO);
+        for (; !(n & 0b1); ++exp) n >>= 1;
+        if (exp) foundFactors.addNewFactor(2, exp);
+    }
+    const TrialDivisionKernel& kernel { TrialDivisionKernel::get() };
+    //small enough that trial division through sqrt(n) finishes within the kernel's range
+    if (static_cast<unsigned>(std::bit_width(n)) <= tierCrossovers.trialDivisionMaxBits) {
+        divideOutTablePrimes(n, foundFactors, std::numeric_limits<uint64_t>::max());
+        if (n > 1ull) foundFactors.addNewFactor(n, 1);
+        return foundFactors;
+    }
+    //the primes most likely to divide n are cheapest to find by trial division, regardless of n's size
+    const uint64_t factorFloor { divideOutTablePrimes(n, foundFactors, tieredTrialBound) };
+    if (n == 1ull) return foundFactors;
+    if (factorFloor > isqrt(n)) {
+        foundFactors.addNewFactor(n, 1);
+        return foundFactors;
+    }
+
+    //prime powers with their exponents; all remaining factors are >= tieredTrialBound == 2^8, so there can be no more than 8 of them
+    std::array<std::pair<uint64_t, unsigned>, 64 / 8> foundPrimes;
+    std::array<std::pair<uint64_t, unsigned>, 64 / 8> unsplit { { { n, 1 } } };
+    size_t foundCount { 0 }, unsplitCount { 1 };
+    while (unsplitCount) {
+        auto [m, mExp] { unsplit[--unsplitCount] };
+        //a perfect power would otherwise cost a full search for its root, as its factors are all the same size
+        const auto [root, rootExp] { perfectPower(m, tieredTrialBound) };
+        m = root;
+        mExp *= rootExp;
+
+        //no factor of m is below factorFloor, so it must be prime if it is below factorFloor's square
+        if (factorFloor > isqrt(m)) foundPrimes[foundCount++] = { m, mExp };
+        //trial division is cheaper than a primality test at this size, and finds the smallest factor outright
+        else if (static_cast<unsigned>(std::bit_width(m)) <= tierCrossovers.trialDivisionMaxBits) {
+            const size_t i { kernel.findDivisor(m, 0, isqrt(m)) };
+            if (i == kernel.getPrimeCount()) foundPrimes[foundCount++] = { m, mExp };
+            else {
+                foundPrimes[foundCount++] = { kernel.getPrime(i), mExp };
+                unsplit[unsplitCount++] = { m / kernel.getPrime(i), mExp };
+            }
+        }
+        else if (isPrimeMillerRabin(m)) foundPrimes[foundCount++] = { m, mExp };
+        else {
+            const uint64_t d { splitCofactor(m) };
+            unsplit[unsplitCount++] = { d, mExp };
+            unsplit[unsplitCount++] = { m / d, mExp };
+        }
+    }
+
+    //factors are found in no particular order, so they are sorted to match the ascending output of trial division
+    //insertion sort, as there are at most 8 elements
+    for (size_t i { 1 }; i < foundCount; ++i)
+        for (size_t j { i }; j && foundPrimes[j - 1].first > foundPrimes[j].first; --j) std::swap(foundPrimes[j - 1], foundPrimes[j]);
+    //the same prime may have been found in more than one cofactor
+    for (size_t i { 0 }, j; i < foundCount; i = j) {
+        unsigned totalExp { 0 };
+        for (j = i; j < foundCount && foundPrimes[j].first == foundPrimes[i].first; ++j) totalExp += foundPrimes[j].second;
+        foundFactors.addNewFactor(foundPrimes[i].first, totalExp);
+    }
+    return foundFactors;
+}
+
+std::pair<uint64_t, unsigned> primes::perfectPower(uint64_t n, const uint64_t minRoot) {
+    //composite exponents are found as repeated prime exponents, e.g. m^6 as (m^3)^2
+    static constexpr std::array<unsigned, 18> primeExponents { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61 };
+
+    unsigned exponent { 1 };
+    for (const unsigned k : primeExponents) {
+        //minRoot^k >= 2^(k * floor(log2(minRoot))), so once that exceeds n no root >= minRoot exists for this or any greater k
+        if (k * (static_cast<unsigned>(std::bit_width(minRoot)) - 1) >= static_cast<unsigned>(std::bit_width(n))) break;
+        for (uint64_t root; (root = iroot(n, k)) >= minRoot; n = root, exponent *= k) {
+            uint64_t power { root };
+            for (unsigned i { 1 }; i < k; ++i) power *= root;
+            if (power != n) break;
+        }
+    }
+    return { n, exponent };
+}
+
+uint64_t primes::iroot(const uint64_t n, const unsigned k) {
+    if (k == 1 || n < 2ull) return n;
+    if (k == 2) return isqrt(n);
+
+    //the double approximation may be off by one in either direction, so it is corrected with overflow checked powers
+    const auto exceedsN = [&](const uint64_t root) {
+        uint64_t power { 1 };
+        for (unsigned i { 0 }; i < k; ++i)
+            if (__builtin_mul_overflow(power, root, &power) || power > n) return true;
+        return false;
+    };
+    uint64_t root { static_cast<uint64_t>(std::pow(static_cast<double>(n), 1.0 / k)) };
+    while (root && exceedsN(root)) --root;
+    while (!exceedsN(root + 1)) ++root;
+    return root;
+}
+
+uint64_t primes::hartOneLineFactor(const uint64_t n, const uint64_t iterationLimit) {
+    for (uint64_t i { 1 }, ni { n }; i <= iterationLimit; ++i, ni += n) {
+        //ceil(sqrt(n * i)); n * i may exceed 2^53, so the double approximation may be off by one in either direction
+        uint64_t s { static_cast<uint64_t>(std::ceil(std::sqrt(static_cast<double>(ni)))) };
+        if (s * s < ni) ++s;
+        else if ((s - 1) * (s - 1) >= ni) --s;
+        //s^2 - n * i < 2s + 1, which is almost always already below n
+        uint64_t m { s * s - ni }, t;
+        if (m >= n) m %= n;
+        if (!isSquare(m, t)) continue;
+        //s^2 == t^2 (mod n), so gcd(s - t, n) is a factor of n, though possibly a trivial one
+        const uint64_t factor { std::gcd(s - t, n) };
+        if (factor > 1ull && factor < n) return factor;
+    }
+    return 0;
+}
+
+uint64_t primes::lehmanFactor(const uint64_t n) {
+    const uint64_t cubeRoot { iroot(n, 3) };
+    const double sixthRoot { std::cbrt(std::sqrt(static_cast<double>(n))) };
+
+    //for some k <= n^(1/3), 4kn == a^2 - b^2 for an a within n^(1/6) / (4 sqrt(k)) of sqrt(4kn)
+    for (uint64_t k { 1 }; k <= cubeRoot + 1; ++k) {
+        const uint64_t fourKN { 4 * k * n };
+        uint64_t a { isqrt(fourKN) };
+        //the extra 1 covers rounding error in the bound
+        const uint64_t maxA { a + static_cast<uint64_t>(sixthRoot / (4 * std::sqrt(static_cast<double>(k)))) + 1 };
+        if (a * a != fourKN) ++a;
+        for (; a <= maxA; ++a) {
+            uint64_t b;
+            if (!isSquare(a * a - fourKN, b)) continue;
+            const uint64_t factor { std::gcd(a + b, n) };
+            if (factor > 1ull && factor < n) return factor;
+        }
+    }
+    return 0;
+}
+
+uint64_t primes::squfof(const uint64_t n) {
+    //products of small distinct odd primes, in ascending order, per gower and wagstaff
+    static constexpr std::array<uint64_t, 16> multipliers { 1, 3, 5, 7, 11, 3*5, 3*7, 3*11, 5*7, 5*11, 7*11, 3*5*7, 3*5*11, 3*7*11, 5*7*11, 3*5*7*11 };
+    //failing to find a square form within this many steps suggests trying the next multiplier instead
+    const uint64_t maxSteps { 6 * isqrt(2 * isqrt(n)) };
+
+    //differences between P values may be negative; unsigned wraparound still yields the correct (positive) Q values
+    for (const uint64_t k : multipliers) {
+        if (n > std::numeric_limits<uint64_t>::max() / k) break;
+        const uint64_t d { k * n }, p0 { isqrt(d) };
+        if (p0 * p0 == d) continue;
+
+        //forward cycle, searching for a square Q at an even step
+        uint64_t p { p0 }, pPrev { p0 }, qPrev { 1 }, q { d - p0 * p0 }, r;
+        uint64_t step { 2 };
+        for (; step < maxSteps; ++step) {
+            const uint64_t b { (p0 + p) / q };
+            p = b * q - p;
+            const uint64_t qNext { qPrev + b * (pPrev - p) };
+            qPrev = q;
+            q = qNext;
+            pPrev = p;
+            if (!(step & 0b1) && isSquare(q, r)) break;
+        }
+        if (step >= maxSteps) continue;
+
+        //reverse cycle from the square root of the form found, until P repeats
+        const uint64_t b { (p0 - p) / r };
+        p = b * r + p;
+        qPrev = r;
+        q = (d - p * p) / qPrev;
+        if (!q) continue;
+        do {
+            const uint64_t b { (p0 + p) / q };
+            pPrev = p;
+            p = b * q - p;
+            const uint64_t qNext { qPrev + b * (pPrev - p) };
+            qPrev = q;
+            q = qNext;
+        } while (p != pPrev);
+
+        const uint64_t factor { std::gcd(n, qPrev) };
+        if (factor > 1ull && factor < n) return factor;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include "factorization.hpp"
+#include "primes.hpp"
+#include "trialkernel.hpp"
+
+namespace primes {
+    //bit widths at or below which each strategy handles a cofactor; cofactors wider than squfofMaxBits go to pollard-brent rho
+    //a strategy is disabled by setting its crossover at or below the previous one's
+    //defaults follow the tier-sweep benchmark: on the hardware measured, rho outpaced both the one line and square forms methods
+    //at every width beyond trial division's on balanced semiprimes (their worst case), so both are disabled unless raised
+    struct TierCrossovers {
+        //trial division through sqrt(n), which stays within TrialDivisionKernel's range through 32 bits
+        unsigned trialDivisionMaxBits { 32 };
+        //hart's one line factorization, falling back on lehman's method, which needs n * n^(1/3) to fit in 64 bits
+        unsigned oneLineMaxBits { 32 };
+        //shanks' square forms factorization, which needs k * n to fit in 64 bits for at least the first few multipliers k
+        unsigned squfofMaxBits { 32 };
+
+        static constexpr unsigned maxTrialDivisionBits = 32, maxOneLineBits = 42, maxSqufofBits = 62;
+    };
+
+    //size tiered dispatch; removes small factors and perfect powers, then splits what remains with the strategy suited to its bit width
+    Factorization tieredFactorization(uint64_t n);
+
+    //returns a nontrivial factor of n using the strategy for n's bit width, for n wider than trialDivisionMaxBits
+    //precondition: n is odd, composite, not a perfect power, and has no prime factors below tieredTrialBound
+    uint64_t splitCofactor(const uint64_t n);
+
+    //crossovers are clamped to their maximums
+    //only to be called while no tiered factorizations are in progress
+    void setTierCrossovers(const TierCrossovers& crossovers);
+    const TierCrossovers& getTierCrossovers(void);
+
+    //returns the smallest m >= minRoot and greatest k such that n == m^k, or { n, 1 } if there is none
+    //precondition: minRoot >= 2
+    std::pair<uint64_t, unsigned> perfectPower(uint64_t n, const uint64_t minRoot = 2);
+
+    //greatest integer <= n^(1/k)
+    //precondition: k > 0
+    uint64_t iroot(const uint64_t n, const unsigned k);
+
+    //the following return a nontrivial factor of n, or 0 if none was found
+    //precondition for each: n is odd, composite, and not a perfect square
+
+    //tries multiples n * i for i in [1, iterationLimit] until ceil(sqrt(n * i))^2 mod n is a perfect square
+    //precondition: n * iterationLimit does not overflow
+    uint64_t hartOneLineFactor(const uint64_t n, const uint64_t iterationLimit);
+    //always succeeds given its precondition
+    //precondition: n has no prime factors <= n^(1/3), and n < 2^maxOneLineBits
+    uint64_t lehmanFactor(const uint64_t n);
+    //tries successive multipliers while k * n fits in 64 bits
+    uint64_t squfof(const uint64_t n);
+
+    //primes below this are found by trial division before any tier is chosen, the same as the rho engine
+    static constexpr uint64_t tieredTrialBound = pollardRhoTrialBound;
+}
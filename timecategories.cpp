@@ -1,11 +1,12 @@
 #include "timecategories.hpp"
 
-void TimeCategories::incrementAppropriateCategory(const long double timeMs) {
+void TimeCategories::tally(const LatencyHistogram& times) {
+    //each category holds the values below its bound that no faster category already holds
+    uint64_t countedSoFar { 0 };
     for (subdivision& sub : subdivisions) {
-        if (timeMs < sub.milliEquiv) { 
-            ++sub.count;
-            break;
-        }
+        const uint64_t below { times.countBelow(sub.nanoEquiv) };
+        sub.count = below - countedSoFar;
+        countedSoFar = below;
     }
 }
 
@@ -20,3 +21,23 @@ void TimeCategories::printout(FILE* outStream) const {
             std::format("{}{}", subdivisions[i + (subdivisionCount / 2)].displayText, subdivisions[i + (subdivisionCount / 2)].count), miniPanelWidth, 
             std::format("{}{}", subdivisions[i + (3 * subdivisionCount / 4)].displayText, subdivisions[i + (3 * subdivisionCount / 4)].count));
 }
+
+void TimeCategories::addHardwareCounts(const uint64_t ns, const HardwareCounts& counts) {
+    //the last category's bound is the greatest possible value, so it catches any ns no other category does
+    subdivision& sub { *std::find_if(subdivisions.begin(), subdivisions.end() - 1, [&](const subdivision& sub){ return ns < sub.nanoEquiv; }) };
+    sub.hardwareCounts += counts;
+    ++sub.countedInputs;
+}
+
+void TimeCategories::mergeHardwareCounts(const TimeCategories& other) {
+    for (size_t i { 0 }; i < subdivisionCount; ++i) {
+        subdivisions[i].hardwareCounts += other.subdivisions[i].hardwareCounts;
+        subdivisions[i].countedInputs += other.subdivisions[i].countedInputs;
+    }
+}
+
+void TimeCategories::printHardwareCounts(FILE* outStream) const {
+    for (const subdivision& sub : subdivisions) 
+        if (sub.countedInputs) 
+            std::println(outStream, "{:{}}{}", std::format("{}{} counted", sub.displayText, sub.countedInputs), miniPanelWidth, formatHardwareCounts(sub.hardwareCounts, sub.countedInputs));
+}
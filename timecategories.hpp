@@ -1,23 +1,40 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <format>
 #include <print>
 #include <string>
+#include <limits>
+#include "latencyhistogram.hpp"
+#include "perfcounters.hpp"
 #include "utils.hpp"
 
 class TimeCategories {
 public:
-    void incrementAppropriateCategory(const long double timeMs);
+    //sets every category's count from the recorded calculation times
+    void tally(const LatencyHistogram& times);
     //output contents of the object to stdout
     void printout(FILE* outStream = stdout) const;
+
+    //adds the hardware event counts of an input that took ns to its category
+    void addHardwareCounts(const uint64_t ns, const HardwareCounts& counts);
+    //adds the hardware event counts of each of other's categories to this one's
+    void mergeHardwareCounts(const TimeCategories& other);
+    //outputs the mean hardware event counts of each category with any counted inputs
+    void printHardwareCounts(FILE* outStream = stdout) const;
     
 private:
     struct subdivision
     {
         std::string displayText;
-        long double milliEquiv;
-        int count;
+        //exclusive upper bound of the category, in nanoseconds
+        uint64_t nanoEquiv;
+        uint64_t count;
+        //sums over the counted inputs in the category, which may be fewer than count
+        HardwareCounts hardwareCounts;
+        uint64_t countedInputs;
     };
     
     constexpr static int
@@ -26,27 +43,27 @@ private:
 
 
     std::array<subdivision, subdivisionCount> subdivisions { subdivision
-        { "<  1  μs: ", .001, 0 },
-        { "< 10  μs: ", .01 , 0 },
-        { "< ⅟8  ms: ", .125 , 0 },
-        { "< ⅟4  ms: ", .25  , 0 },
-        { "< ⅟2  ms: ", .5   , 0 },
-        { "<  1  ms: ",     1, 0 },
-        { "< 10  ms: ",    10, 0 },
-        { "< ⅟4 sec: ",   250, 0 },
-        { "< ⅟2 sec: ",   500, 0 },
-        { "<  1 sec: ",  1000, 0 },
+        { "<  1  μs: ",                                1'000, 0, {}, 0 },
+        { "< 10  μs: ",                               10'000, 0, {}, 0 },
+        { "< ⅟8  ms: ",                              125'000, 0, {}, 0 },
+        { "< ⅟4  ms: ",                              250'000, 0, {}, 0 },
+        { "< ⅟2  ms: ",                              500'000, 0, {}, 0 },
+        { "<  1  ms: ",                            1'000'000, 0, {}, 0 },
+        { "< 10  ms: ",                           10'000'000, 0, {}, 0 },
+        { "< ⅟4 sec: ",                          250'000'000, 0, {}, 0 },
+        { "< ⅟2 sec: ",                          500'000'000, 0, {}, 0 },
+        { "<  1 sec: ",                        1'000'000'000, 0, {}, 0 },
         
         //uses the value of the next category (< that == >= period shown in strings for purposes of this class)
-        { ">=  1 sec: ",     3000, 0 },
-        { ">=  3 sec: ",     5000, 0 },
-        { ">=  5 sec: ",    10000, 0 },
-        { ">= 10 sec: ",    30000, 0 },
-        { ">= 30 sec: ",    60000, 0 },
-        { ">=  1 min: ",  3000000, 0 },
-        { ">=  5 min: ",  6000000, 0 },
-        { ">= 10 min: ", 18000000, 0 },
-        { ">= 30 min: ", 36000000, 0 },
-        { ">=  1  hr: ", std::numeric_limits<long double>::infinity(), 0 } 
+        { ">=  1 sec: ",                        3'000'000'000, 0, {}, 0 },
+        { ">=  3 sec: ",                        5'000'000'000, 0, {}, 0 },
+        { ">=  5 sec: ",                       10'000'000'000, 0, {}, 0 },
+        { ">= 10 sec: ",                       30'000'000'000, 0, {}, 0 },
+        { ">= 30 sec: ",                       60'000'000'000, 0, {}, 0 },
+        { ">=  1 min: ",                      300'000'000'000, 0, {}, 0 },
+        { ">=  5 min: ",                      600'000'000'000, 0, {}, 0 },
+        { ">= 10 min: ",                    1'800'000'000'000, 0, {}, 0 },
+        { ">= 30 min: ",                    3'600'000'000'000, 0, {}, 0 },
+        { ">=  1  hr: ", std::numeric_limits<uint64_t>::max(), 0, {}, 0 } 
     };
 };
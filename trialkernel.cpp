@@ -0,0 +1,135 @@
+#include "trialkernel.hpp"
+
+#include <algorithm>
+#include <immintrin.h>
+#include <limits>
+#include "opcounter.hpp"
+
+template<class Word>
+BasicTrialDivisionKernel<Word>::BasicTrialDivisionKernel(const InstructionSet requested) {
+    if (requested == InstructionSet::AVX512 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+        instructionSet = InstructionSet::AVX512;
+    else if (requested != InstructionSet::SCALAR && __builtin_cpu_supports("avx2"))
+        instructionSet = InstructionSet::AVX2;
+    else
+        instructionSet = InstructionSet::SCALAR;
+
+    //inverses are shared with the compile time FastDivisor table, truncated to Word; only the limits need computing here
+    for (const FastDivisor& divisor : primes::smallFastDivisors) {
+        inverses.push_back(static_cast<Word>(divisor.getInverse()));
+        limits.push_back(std::numeric_limits<Word>::max() / divisor.getDivisor());
+        kernelPrimes.push_back(divisor.getDivisor());
+    }
+    primeCount = kernelPrimes.size();
+
+    //n * 1 <= 0 only for n == 0, which is never odd
+    inverses.insert(inverses.end(), padding, 1);
+    limits.insert(limits.end(), padding, 0);
+    kernelPrimes.insert(kernelPrimes.end(), padding, std::numeric_limits<uint32_t>::max());
+}
+
+template<class Word>
+const BasicTrialDivisionKernel<Word>& BasicTrialDivisionKernel<Word>::get(void) {
+    static const BasicTrialDivisionKernel kernel;
+    return kernel;
+}
+
+template<class Word>
+size_t BasicTrialDivisionKernel<Word>::findDivisor(const Word n, const size_t first, const uint64_t maxDivisor) const {
+    const OperationCounter::StageScope stage(OperationCounts::SMALL_PRIMES);
+    size_t found;
+    switch (instructionSet) {
+    case InstructionSet::AVX512:
+        found = findDivisorAVX512(n, first, maxDivisor);
+        break;
+    case InstructionSet::AVX2:
+        found = findDivisorAVX2(n, first, maxDivisor);
+        break;
+    case InstructionSet::SCALAR:
+    default:
+        found = findDivisorScalar(n, first, maxDivisor);
+    }
+    #ifdef COUNT_OPERATIONS
+    //counts the primes a scalar scan would have tested, so that counts do not depend on the instruction set
+    const size_t last { found < primeCount ? found + 1 : static_cast<size_t>(
+        std::upper_bound(kernelPrimes.begin() + std::min(first, primeCount), kernelPrimes.begin() + primeCount, maxDivisor) - kernelPrimes.begin()) };
+    if (last > first) OperationCounter::countTrialDivisions(last - first);
+    #endif
+    return found;
+}
+
+template<class Word>
+size_t BasicTrialDivisionKernel<Word>::findDivisorScalar(const Word n, size_t first, const uint64_t maxDivisor) const {
+    for (; first < primeCount && kernelPrimes[first] <= maxDivisor; ++first)
+        if (divides(n, first)) return first;
+    return primeCount;
+}
+
+template<>
+__attribute__((target("avx2")))
+size_t BasicTrialDivisionKernel<uint64_t>::findDivisorAVX2(const uint64_t n, size_t first, const uint64_t maxDivisor) const {
+    const __m256i nLanes { _mm256_set1_epi64x(n) }, nHighLanes { _mm256_srli_epi64(nLanes, 32) };
+    //AVX2 only has signed 64 bit comparisons, so both sides are offset by 2^63 to compare as unsigned
+    const __m256i signBit { _mm256_set1_epi64x(std::numeric_limits<int64_t>::min()) };
+
+    for (; first < primeCount && kernelPrimes[first] <= maxDivisor; first += 4) {
+        const __m256i inverseLanes { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inverses.data() + first)) };
+        const __m256i limitLanes { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(limits.data() + first)) };
+
+        //AVX2 also lacks a 64 bit low multiply, so it is assembled from 32 bit partial products
+        //the high * high partial product only affects bits beyond the low 64
+        const __m256i crossProducts { _mm256_add_epi64(
+            _mm256_mul_epu32(nHighLanes, inverseLanes),
+            _mm256_mul_epu32(nLanes, _mm256_srli_epi64(inverseLanes, 32))) };
+        const __m256i products { _mm256_add_epi64(_mm256_mul_epu32(nLanes, inverseLanes), _mm256_slli_epi64(crossProducts, 32)) };
+
+        const __m256i exceedsLimit { _mm256_cmpgt_epi64(_mm256_xor_si256(products, signBit), _mm256_xor_si256(limitLanes, signBit)) };
+        const unsigned divisibleMask { ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(exceedsLimit))) & 0xF };
+        if (divisibleMask) return first + __builtin_ctz(divisibleMask);
+    }
+    return primeCount;
+}
+
+template<>
+__attribute__((target("avx2")))
+size_t BasicTrialDivisionKernel<uint32_t>::findDivisorAVX2(const uint32_t n, size_t first, const uint64_t maxDivisor) const {
+    const __m256i nLanes { _mm256_set1_epi32(n) };
+
+    for (; first < primeCount && kernelPrimes[first] <= maxDivisor; first += 8) {
+        const __m256i products { _mm256_mullo_epi32(nLanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inverses.data() + first))) };
+        //AVX2 has no unsigned comparison, but products <= limits exactly where min(products, limits) == products
+        const __m256i withinLimit { _mm256_cmpeq_epi32(_mm256_min_epu32(products, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(limits.data() + first))), products) };
+        const unsigned divisibleMask { static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(withinLimit))) };
+        if (divisibleMask) return first + __builtin_ctz(divisibleMask);
+    }
+    return primeCount;
+}
+
+template<>
+__attribute__((target("avx512f,avx512dq")))
+size_t BasicTrialDivisionKernel<uint64_t>::findDivisorAVX512(const uint64_t n, size_t first, const uint64_t maxDivisor) const {
+    const __m512i nLanes { _mm512_set1_epi64(n) };
+
+    for (; first < primeCount && kernelPrimes[first] <= maxDivisor; first += 8) {
+        const __m512i products { _mm512_mullo_epi64(nLanes, _mm512_loadu_si512(inverses.data() + first)) };
+        const __mmask8 divisibleMask { _mm512_cmple_epu64_mask(products, _mm512_loadu_si512(limits.data() + first)) };
+        if (divisibleMask) return first + __builtin_ctz(divisibleMask);
+    }
+    return primeCount;
+}
+
+template<>
+__attribute__((target("avx512f")))
+size_t BasicTrialDivisionKernel<uint32_t>::findDivisorAVX512(const uint32_t n, size_t first, const uint64_t maxDivisor) const {
+    const __m512i nLanes { _mm512_set1_epi32(n) };
+
+    for (; first < primeCount && kernelPrimes[first] <= maxDivisor; first += 16) {
+        const __m512i products { _mm512_mullo_epi32(nLanes, _mm512_loadu_si512(inverses.data() + first)) };
+        const __mmask16 divisibleMask { _mm512_cmple_epu32_mask(products, _mm512_loadu_si512(limits.data() + first)) };
+        if (divisibleMask) return first + __builtin_ctz(divisibleMask);
+    }
+    return primeCount;
+}
+
+template class BasicTrialDivisionKernel<uint32_t>;
+template class BasicTrialDivisionKernel<uint64_t>;
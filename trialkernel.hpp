@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "fastdivisor.hpp"
+
+//tests n for divisibility by many small odd primes at once, without any hardware division
+//for odd p, n is divisible by p iff n * p^-1 (mod 2^w) <= floor((2^w - 1) / p), and if so n * p^-1 is exactly n / p,
+//where w is the width of Word (uint32_t or uint64_t)
+//512 / w (AVX-512) or 256 / w (AVX2) primes are tested per step, selected at runtime according to CPU support, with a scalar fallback
+//so the 32 bit kernel tests twice as many primes per step, and covers every prime needed to factor a 32 bit n
+template<class Word>
+class BasicTrialDivisionKernel {
+public:
+    enum class InstructionSet {
+        SCALAR, AVX2, AVX512
+    };
+
+    //builds tables for every odd prime below kernelBound
+    //instructionSet is clamped to what the CPU supports
+    BasicTrialDivisionKernel(const InstructionSet requested = InstructionSet::AVX512);
+
+    //shared instance using the best instruction set available
+    static const BasicTrialDivisionKernel& get(void);
+
+    //returns the index of the first prime at or after index first which divides n,
+    //or getPrimeCount() if none do before the primes exceed maxDivisor
+    //primes up to one step's width beyond maxDivisor may also be tested
+    //precondition: n is odd
+    size_t findDivisor(const Word n, const size_t first, const uint64_t maxDivisor) const;
+
+    bool divides(const Word n, const size_t i) const { return static_cast<Word>(n * inverses[i]) <= limits[i]; }
+    //precondition: divides(n, i)
+    Word divideExact(const Word n, const size_t i) const { return n * inverses[i]; }
+
+    uint64_t getPrime(const size_t i) const { return kernelPrimes[i]; }
+    size_t getPrimeCount(void) const { return primeCount; }
+    InstructionSet getInstructionSet(void) const { return instructionSet; }
+
+    static constexpr uint64_t kernelBound = primes::smallFastDivisorBound;
+
+private:
+    size_t findDivisorScalar(const Word n, size_t first, const uint64_t maxDivisor) const;
+    size_t findDivisorAVX2(const Word n, size_t first, const uint64_t maxDivisor) const;
+    size_t findDivisorAVX512(const Word n, size_t first, const uint64_t maxDivisor) const;
+
+    //tables are padded by a full AVX-512 step with entries that never divide any odd n, so steps never read out of bounds
+    static constexpr size_t padding = 64 / sizeof(Word);
+
+    InstructionSet instructionSet;
+    size_t primeCount;
+    //stored as separate arrays so that each step loads contiguous lanes
+    std::vector<Word> inverses, limits;
+    std::vector<uint32_t> kernelPrimes;
+};
+
+using TrialDivisionKernel = BasicTrialDivisionKernel<uint64_t>;
+using TrialDivisionKernel32 = BasicTrialDivisionKernel<uint32_t>;
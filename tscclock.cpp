@@ -0,0 +1,70 @@
+#include "tscclock.hpp"
+#include <algorithm>
+#include <format>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+//true if the processor reports an invariant TSC (CPUID leaf 0x80000007, EDX bit 8)
+static bool hasInvariantTsc(void) {
+    #if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) return false;
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return edx & (1u << 8);
+    #else
+    return false;
+    #endif
+}
+
+void TscClock::calibrate(void) {
+    if (calibrated) return;
+    useTsc = hasInvariantTsc();
+
+    if (useTsc) {
+        //the counter is read both inside and outside the steady_clock readings, and the rate taken as the mean of the two
+        const uint64_t outerStart { start() };
+        const auto clockStart { std::chrono::steady_clock::now() };
+        const uint64_t innerStart { start() };
+        auto clockStop { clockStart };
+        while ((clockStop = std::chrono::steady_clock::now()) - clockStart < calibrationTime);
+        const uint64_t innerStop { stop() };
+        clockStop = std::chrono::steady_clock::now();
+        const uint64_t outerStop { stop() };
+        const long double elapsedNanos { std::chrono::duration<long double, std::nano>(clockStop - clockStart).count() };
+        ticksPerNano = ((outerStop - outerStart) + (innerStop - innerStart)) / (2 * elapsedNanos);
+        nanosPerTick = 1 / ticksPerNano;
+    }
+
+    overheadTicks = std::numeric_limits<uint64_t>::max();
+    for (unsigned i { 0 }; i < overheadSamples; ++i) {
+        const uint64_t begin { start() };
+        overheadTicks = std::min(overheadTicks, stop() - begin);
+    }
+    calibrated = true;
+}
+
+bool TscClock::isUsingTsc(void) {
+    return useTsc;
+}
+
+long double TscClock::getTicksPerNano(void) {
+    return ticksPerNano;
+}
+
+uint64_t TscClock::getOverheadTicks(void) {
+    return overheadTicks;
+}
+
+long double TscClock::ticksToNanos(const uint64_t ticks) {
+    return ticks * nanosPerTick;
+}
+
+std::chrono::duration<long double, std::milli> TscClock::ticksToDuration(const uint64_t ticks) {
+    return std::chrono::duration<long double, std::nano>(ticksToNanos(ticks));
+}
+
+std::string TscClock::describeSource(void) {
+    if (useTsc) return std::format("TSC (invariant, {:.3f}GHz)", ticksPerNano);
+    return "steady_clock (no invariant TSC)";
+}
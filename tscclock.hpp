@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//interval timer reading the time stamp counter, for timing work too short for steady_clock's overhead to be negligible
+//readings are raw integer ticks, converted to time only when reported, at the rate measured against steady_clock by calibrate
+//falls back on steady_clock (one tick per clock period) where there is no invariant TSC, i.e. one that ticks at a constant rate in every power state
+class TscClock {
+public:
+    //begins an interval
+    //the fences keep earlier instructions from completing after the read, and the timed work from starting before it
+    static uint64_t start(void) {
+        #if defined(__x86_64__) || defined(__i386__)
+        if (useTsc) {
+            _mm_lfence();
+            const uint64_t ticks { __rdtsc() };
+            _mm_lfence();
+            return ticks;
+        }
+        #endif
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    //ends an interval
+    //rdtscp waits for the timed work to complete, and the fence keeps later instructions from starting before the read
+    static uint64_t stop(void) {
+        #if defined(__x86_64__) || defined(__i386__)
+        if (useTsc) {
+            unsigned processor;
+            const uint64_t ticks { __rdtscp(&processor) };
+            _mm_lfence();
+            return ticks;
+        }
+        #endif
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    //the counter alone, without fences, for instrumentation where a few cycles of skew either way are acceptable
+    static uint64_t read(void) {
+        #if defined(__x86_64__) || defined(__i386__)
+        if (useTsc) return __rdtsc();
+        #endif
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    //measures the tick rate and the cost of an empty start/stop pair
+    //blocks for about calibrationTime; repeated calls do nothing
+    static void calibrate(void);
+
+    static bool isUsingTsc(void);
+    static long double getTicksPerNano(void);
+    //least ticks measured by an empty start/stop pair, and so included in every interval measured
+    static uint64_t getOverheadTicks(void);
+
+    static long double ticksToNanos(const uint64_t ticks);
+    static std::chrono::duration<long double, std::milli> ticksToDuration(const uint64_t ticks);
+
+    //e.g. "TSC (invariant, 2.995GHz)"
+    static std::string describeSource(void);
+
+    //marks an interval that was never measured
+    static constexpr uint64_t untimed = std::numeric_limits<uint64_t>::max();
+
+private:
+    static constexpr std::chrono::milliseconds calibrationTime { 20 };
+    //empty start/stop pairs measured, the least of which is taken as the overhead
+    static constexpr unsigned overheadSamples = 1 << 12;
+
+    static inline bool useTsc = false;
+    static inline bool calibrated = false;
+    //steady_clock's rate until calibrated
+    static inline long double ticksPerNano = static_cast<long double>(std::chrono::steady_clock::period::den) / std::chrono::steady_clock::period::num / 1e9L;
+    //reciprocal of ticksPerNano, so that conversions multiply rather than divide
+    static inline long double nanosPerTick = 1 / ticksPerNano;
+    static inline uint64_t overheadTicks = 0;
+};
@@ -1,10 +1,28 @@
 #include "utils.hpp"
 
+#include <algorithm>
+#include <iterator>
+
+static bool plainTextOutput { false };
+
+void setPlainTextOutput(const bool plain) {
+    plainTextOutput = plain;
+}
+
+bool isPlainTextOutput(void) {
+    return plainTextOutput;
+}
+
+const char* rewriteLineEscape(void) {
+    return plainTextOutput ? "" : "\033[A\33[2K\r";
+}
+
 void printDivider(std::string&& leftHeader, std::string&& rightHeader, FILE* outStream) {
     static constexpr size_t indent = 3;
     //bold, underline, overline, bright-white series of fill dashes with header text inserted left aligned to each panel, 
     //indented according to indent
-    std::println(outStream, "\033[1;4;53;97m{:-<{}}{:-<{}}{:-<{}}\033[0m", "", indent, leftHeader, panelWidth, rightHeader, panelWidth - indent);
+    if (plainTextOutput) std::println(outStream, "{:-<{}}{:-<{}}{:-<{}}", "", indent, leftHeader, panelWidth, rightHeader, panelWidth - indent);
+    else std::println(outStream, "\033[1;4;53;97m{:-<{}}{:-<{}}{:-<{}}\033[0m", "", indent, leftHeader, panelWidth, rightHeader, panelWidth - indent);
 }
 
 void printDivider(std::string&& leftHeader, FILE* outStream) {
@@ -14,3 +32,33 @@ void printDivider(std::string&& leftHeader, FILE* outStream) {
 void printDivider(FILE* outStream) {
     printDivider("", "", outStream);
 }
+
+std::string toDecimalString(unsigned __int128 n) {
+    //2^128 - 1 has 39 digits
+    char digits[39];
+    return std::string(digits, toDecimalChars(digits, n));
+}
+
+char* toDecimalChars(char* out, unsigned __int128 n) {
+    //digits are generated least significant first, then moved into place
+    char digits[39];
+    char* first { std::end(digits) };
+    do {
+        *--first = '0' + static_cast<char>(n % 10);
+        n /= 10;
+    } while (n);
+    return std::copy(first, std::end(digits), out);
+}
+
+std::optional<unsigned __int128> parseUint128(const std::string_view text) {
+    if (text.empty()) return std::nullopt;
+    static constexpr unsigned __int128 max { ~static_cast<unsigned __int128>(0) };
+    unsigned __int128 n { 0 };
+    for (const char c : text) {
+        if (c < '0' || c > '9') return std::nullopt;
+        const unsigned digit = c - '0';
+        if (n > (max - digit) / 10) return std::nullopt;
+        n = n * 10 + digit;
+    }
+    return n;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <print>
 
 constexpr size_t panelWidth = 72;
@@ -9,3 +11,17 @@ constexpr size_t miniPanelWidth = panelWidth / 2;
 void printDivider(std::string&& leftHeader = "", std::string&& rightHeader = "", FILE* outStream = stdout);
 void printDivider(std::string&& leftHeader, FILE* outStream);
 void printDivider(FILE* outStream);
+
+//plain text output omits ANSI escape sequences (styling and line rewrites), e.g. for output redirected to a file
+void setPlainTextOutput(const bool plain);
+bool isPlainTextOutput(void);
+//moves the cursor to the start of the previous line and clears it, so that it can be rewritten in place; empty in plain text output
+const char* rewriteLineEscape(void);
+
+//std::format and std::from_chars have no portable support for 128 bit integers
+std::string toDecimalString(unsigned __int128 n);
+//writes n's decimal digits starting at out, returning the end of the digits written
+//precondition: at least 39 characters are available
+char* toDecimalChars(char* out, unsigned __int128 n);
+//returns nullopt if text is not entirely decimal digits or the value does not fit in 128 bits
+std::optional<unsigned __int128> parseUint128(const std::string_view text);
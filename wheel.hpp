@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+
+//steps through the integers coprime to the first basisSize primes in ascending order, from any starting point
+//once those primes have been divided out of n, only such integers can be its least remaining prime factor, and stepping between
+//them by a table of gaps replaces the runtime modulo otherwise needed to skip multiples of 3, 5, 7, ...
+//basisSize 1 steps through odd numbers, 2 through the mod 6 wheel, 4 the mod 210 wheel and 5 the mod 2310 wheel
+//every table is generated at compile time
+template<size_t basisSize>
+class Wheel {
+    static_assert(basisSize >= 1 && basisSize <= 5, "gaps are stored in bytes, and larger wheels outgrow the cache for little gain");
+
+public:
+    static constexpr std::array<uint64_t, basisSize> basis { []{
+        std::array<uint64_t, basisSize> primes;
+        size_t count { 0 };
+        for (uint64_t candidate { 2 }; count < basisSize; ++candidate) {
+            bool isPrime { true };
+            for (size_t i { 0 }; i < count; ++i) isPrime &= candidate % primes[i] != 0;
+            if (isPrime) primes[count++] = candidate;
+        }
+        return primes;
+    }() };
+
+    //the product of the basis primes, after which the gaps repeat
+    static constexpr uint64_t circumference { std::accumulate(basis.begin(), basis.end(), uint64_t { 1 }, std::multiplies<uint64_t>()) };
+
+    //residues coprime to circumference, i.e. the candidates per revolution
+    static constexpr size_t spokeCount { []{
+        size_t count { 0 };
+        for (uint64_t r { 0 }; r < circumference; ++r) count += std::gcd(r, circumference) == 1;
+        return count;
+    }() };
+
+    //positioned at the least candidate >= from
+    constexpr explicit Wheel(const uint64_t from) :
+        spoke(firstSpokes[from % circumference]), candidate(from - from % circumference + residues[spoke]) {}
+
+    constexpr uint64_t get(void) const { return candidate; }
+    constexpr void advance(void) {
+        candidate += gaps[spoke];
+        if (++spoke == spokeCount) spoke = 0;
+    }
+
+private:
+    static constexpr std::array<uint16_t, spokeCount> residues { []{
+        std::array<uint16_t, spokeCount> coprimes;
+        for (size_t i { 0 }, r { 0 }; r < circumference; ++r) if (std::gcd(r, circumference) == 1) coprimes[i++] = r;
+        return coprimes;
+    }() };
+
+    //gaps[i] leads from residues[i] to the next candidate, wrapping from the last residue into the next revolution
+    static constexpr std::array<uint8_t, spokeCount> gaps { []{
+        std::array<uint8_t, spokeCount> steps;
+        for (size_t i { 0 }; i < spokeCount; ++i) steps[i] = (i + 1 < spokeCount ? residues[i + 1] : circumference + residues[0]) - residues[i];
+        return steps;
+    }() };
+
+    //firstSpokes[r] is the first spoke whose residue is >= r
+    //circumference - 1 is always coprime to circumference, so every r has one within the same revolution
+    static constexpr std::array<uint16_t, circumference> firstSpokes { []{
+        std::array<uint16_t, circumference> spokes;
+        for (size_t r { circumference }, i { spokeCount }; r-- > 0;) {
+            if (std::gcd(r, circumference) == 1) --i;
+            spokes[r] = i;
+        }
+        return spokes;
+    }() };
+
+    size_t spoke;
+    uint64_t candidate;
+};
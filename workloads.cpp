@@ -0,0 +1,58 @@
+#include "workloads.hpp"
+
+std::string_view workloadName(const Workload workload) {
+    switch (workload) {
+    case Workload::BALANCED_SEMIPRIME: return "semiprime";
+    case Workload::PRIME:              return "prime";
+    case Workload::PRIME_POWER:        return "prime-power";
+    case Workload::SMOOTH:             return "smooth";
+    case Workload::UNIFORM:            return "uniform";
+    }
+    return "";
+}
+
+uint64_t randomPrime(SplitMix64& gen, const unsigned bits) {
+    for (;;) {
+        const uint64_t candidate { (gen() >> (64 - bits)) | (1ull << (bits - 1)) | 0b1 };
+        if (primes::isPrimeMillerRabin(candidate)) return candidate;
+    }
+}
+
+std::vector<uint64_t> generateWorkload(const Workload workload, const unsigned bits, const size_t count, const uint64_t seed) {
+    SplitMix64 gen(seed);
+    //2^bits - 1, computed without shifting by 64
+    const uint64_t maxInput { std::numeric_limits<uint64_t>::max() >> (64 - bits) };
+
+    std::vector<uint64_t> inputs;
+    inputs.reserve(count);
+    while (inputs.size() < count) {
+        switch (workload) {
+        case Workload::BALANCED_SEMIPRIME:
+            inputs.push_back(randomPrime(gen, bits / 2) * randomPrime(gen, bits - bits / 2));
+            break;
+        case Workload::PRIME:
+            inputs.push_back(randomPrime(gen, bits));
+            break;
+        case Workload::PRIME_POWER: {
+            //exponents from 2 through 5, with the base narrowed to keep p^k below 2^bits
+            const unsigned exp { std::min(2 + static_cast<unsigned>(gen() % 4), bits / 2) };
+            const uint64_t base { randomPrime(gen, bits / exp) };
+            uint64_t power { 1 };
+            for (unsigned i { 0 }; i < exp; ++i) power *= base;
+            inputs.push_back(power);
+            break;
+        }
+        case Workload::SMOOTH: {
+            //multiplied until the next prime could overflow, leaving the product within a factor of smoothBound of 2^bits
+            uint64_t product { 1 };
+            while (product <= maxInput / smoothBound) product *= randomPrime(gen, 2 + gen() % 15);
+            inputs.push_back(product == 1 ? randomPrime(gen, bits) : product);
+            break;
+        }
+        case Workload::UNIFORM:
+            inputs.push_back((gen() >> (64 - bits)) | (1ull << (bits - 1)));
+            break;
+        }
+    }
+    return inputs;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "primes.hpp"
+#include "splitmix64.hpp"
+
+//classes of inputs that stress different parts of the engines, for benchmarks that must be repeatable from a seed
+enum class Workload {
+    BALANCED_SEMIPRIME, //p * q with p and q random primes of half the width each; the hardest case for every splitting strategy
+    PRIME,              //a random prime, i.e. nothing to split, only primality to prove
+    PRIME_POWER,        //p^k for k >= 2, exercising perfect power detection
+    SMOOTH,             //a product of random primes below smoothBound, found entirely by the small factor stage
+    UNIFORM             //uniformly random, as randomInputTest generates
+};
+
+static constexpr Workload workloads[] { Workload::BALANCED_SEMIPRIME, Workload::PRIME, Workload::PRIME_POWER, Workload::SMOOTH, Workload::UNIFORM };
+
+//e.g. "semiprime"
+std::string_view workloadName(const Workload workload);
+
+//every prime factor of a SMOOTH input is below this
+static constexpr uint64_t smoothBound = 1u << 16;
+
+//count inputs of the given class, each below 2^bits
+//primes and uniform inputs have exactly bits bits, balanced semiprimes bits - 1 or bits, and the rest as close to bits as their factors allow
+//the same seed always gives the same inputs
+//precondition: 4 <= bits <= 64
+std::vector<uint64_t> generateWorkload(const Workload workload, const unsigned bits, const size_t count, const uint64_t seed);
+
+//a random prime with its highest bit at position bits - 1
+//precondition: 2 <= bits <= 64
+uint64_t randomPrime(SplitMix64& gen, const unsigned bits);
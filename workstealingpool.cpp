@@ -0,0 +1,74 @@
+#include "workstealingpool.hpp"
+
+WorkStealingPool::WorkStealingPool(const unsigned threadCount_) : 
+    threadCount(std::max(threadCount_, 1u)), 
+    queues(std::make_unique<ChunkQueue[]>(threadCount)), 
+    reports(threadCount) {}
+
+void WorkStealingPool::run(const uint64_t chunkCount, const std::function<uint64_t(const unsigned, const uint64_t)>& processChunk) {
+    for (unsigned i { 0 }; i < threadCount; ++i) {
+        queues[i].front = chunkCount * i / threadCount;
+        queues[i].back = chunkCount * (i + 1) / threadCount;
+    }
+
+    const auto work = [&](const unsigned worker) {
+        const auto start { std::chrono::steady_clock::now() };
+        do {
+            for (std::optional<uint64_t> chunk; (chunk = takeOwnChunk(worker)); ++reports[worker].chunksProcessed)
+                reports[worker].inputsProcessed += processChunk(worker, *chunk);
+        //chunks only ever move between queues, so once no queue has any left to steal, this worker's part is done
+        } while (stealChunks(worker));
+        reports[worker].busyTime += std::chrono::steady_clock::now() - start;
+    };
+
+    std::vector<std::jthread> workers;
+    workers.reserve(threadCount - 1);
+    for (unsigned i { 1 }; i < threadCount; ++i) workers.emplace_back(work, i);
+    //the calling thread acts as worker 0
+    work(0);
+}
+
+unsigned WorkStealingPool::getThreadCount(void) const {
+    return threadCount;
+}
+
+const std::vector<WorkStealingPool::WorkerReport>& WorkStealingPool::viewReports(void) const {
+    return reports;
+}
+
+std::optional<uint64_t> WorkStealingPool::takeOwnChunk(const unsigned worker) {
+    std::scoped_lock guard(queues[worker].lock);
+    if (queues[worker].front == queues[worker].back) return std::nullopt;
+    return queues[worker].front++;
+}
+
+bool WorkStealingPool::stealChunks(const unsigned thief) {
+    //the scan only picks a likely victim; whether it still has chunks left is rechecked when stealing
+    while (true) {
+        unsigned victim { thief };
+        uint64_t mostRemaining { 0 };
+        for (unsigned i { 0 }; i < threadCount; ++i) {
+            std::scoped_lock guard(queues[i].lock);
+            if (queues[i].back - queues[i].front > mostRemaining) {
+                mostRemaining = queues[i].back - queues[i].front;
+                victim = i;
+            }
+        }
+        if (!mostRemaining) return false;
+
+        uint64_t stolenFront, stolenBack;
+        {
+            std::scoped_lock guard(queues[victim].lock);
+            const uint64_t remaining { queues[victim].back - queues[victim].front };
+            //another thief got there first
+            if (!remaining) continue;
+            stolenBack = queues[victim].back;
+            stolenFront = queues[victim].back -= (remaining + 1) / 2;
+        }
+        std::scoped_lock guard(queues[thief].lock);
+        queues[thief].front = stolenFront;
+        queues[thief].back = stolenBack;
+        reports[thief].chunksStolen += stolenBack - stolenFront;
+        return true;
+    }
+}
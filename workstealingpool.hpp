@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+//distributes a fixed number of chunks of work across a set of threads
+//each thread starts with an even share of the chunks, and once out of its own, steals half of the remainder of the busiest thread
+//this keeps every thread busy even when the cost of individual chunks varies by orders of magnitude
+class WorkStealingPool {
+public:
+    struct WorkerReport {
+        uint64_t inputsProcessed = 0, chunksProcessed = 0, chunksStolen = 0;
+        std::chrono::duration<long double> busyTime { 0 };
+    };
+
+    WorkStealingPool(const unsigned threadCount_);
+
+    //calls processChunk(workerIndex, chunkIndex) exactly once for each chunkIndex in [0, chunkCount), returning once all have completed
+    //processChunk returns the number of inputs it handled, which is used only for reporting
+    void run(const uint64_t chunkCount, const std::function<uint64_t(const unsigned, const uint64_t)>& processChunk);
+
+    unsigned getThreadCount(void) const;
+    const std::vector<WorkerReport>& viewReports(void) const;
+
+private:
+    //a contiguous range of unprocessed chunks; the owner takes from the front while thieves take from the back
+    //aligned to avoid false sharing between threads
+    struct alignas(64) ChunkQueue {
+        std::mutex lock;
+        uint64_t front = 0, back = 0;
+    };
+
+    std::optional<uint64_t> takeOwnChunk(const unsigned worker);
+    //returns true if any chunks were moved into the thief's queue
+    bool stealChunks(const unsigned thief);
+
+    const unsigned threadCount;
+    std::unique_ptr<ChunkQueue[]> queues;
+    std::vector<WorkerReport> reports;
+};